@@ -0,0 +1,164 @@
+#include "atlas.hpp"
+#include "jobs.hpp"
+#include "raylib.h"
+#include "terrain.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr std::array<char, 8> MAGIC = {'S', 'R', 'A', 'T', 'L', 'A', 'S', '1'};
+
+// fixed 64-byte header keeps every tile 4-byte aligned inside the page-aligned mapping
+struct Header {
+    std::array<char, 8> magic;
+    int32_t resolution; // vertices along a chunk edge
+    float chunk_size;
+    int32_t min_cx;
+    int32_t min_cz;
+    int32_t width;
+    int32_t depth;
+    std::array<std::byte, 32> reserved;
+};
+static_assert(sizeof(Header) == 64);
+
+struct TileLayout {
+    size_t vertex_count;
+    size_t normals_offset;
+    size_t colors_offset;
+    size_t size;
+};
+
+TileLayout get_tile_layout(int32_t resolution) {
+    const auto vertex_count = static_cast<size_t>(resolution) * static_cast<size_t>(resolution);
+    const size_t normals_offset = vertex_count * 3 * sizeof(float);
+    const size_t colors_offset = normals_offset + vertex_count * 3 * sizeof(float);
+    return {vertex_count, normals_offset, colors_offset, colors_offset + vertex_count * 4};
+}
+
+struct AtlasState {
+    const std::byte *mapping = nullptr;
+    size_t mapping_size = 0;
+    Header header = {};
+    TileLayout layout = {};
+} internal_state;
+
+} // namespace
+
+namespace Atlas {
+
+bool bake(std::string_view path, int32_t min_cx, int32_t min_cz, int32_t width, int32_t depth) {
+    if (width <= 0 || depth <= 0) {
+        return false;
+    }
+    const std::unique_ptr<std::FILE, decltype(&std::fclose)> file(std::fopen(std::string(path).c_str(), "wb"), &std::fclose);
+    if (!file) {
+        return false;
+    }
+
+    const Header header = {
+        .magic = MAGIC,
+        .resolution = Terrain::get_chunk_resolution(),
+        .chunk_size = Terrain::get_chunk_size(),
+        .min_cx = min_cx,
+        .min_cz = min_cz,
+        .width = width,
+        .depth = depth,
+        .reserved = {},
+    };
+    if (std::fwrite(&header, sizeof(header), 1, file.get()) != 1) {
+        return false;
+    }
+
+    // one row of tiles is generated across cores, then streamed out in file order
+    const TileLayout layout = get_tile_layout(header.resolution);
+    std::vector<std::byte> row(layout.size * static_cast<size_t>(width));
+    for (int32_t z = 0; z < depth; ++z) {
+        Jobs::parallel_for(width, [&](int32_t x) {
+            std::byte *tile = row.data() + layout.size * static_cast<size_t>(x);
+            Mesh mesh = {};
+            mesh.vertices = reinterpret_cast<float *>(tile);
+            mesh.normals = reinterpret_cast<float *>(tile + layout.normals_offset);
+            mesh.colors = reinterpret_cast<unsigned char *>(tile + layout.colors_offset);
+            Terrain::generate_chunk(mesh, min_cx + x, min_cz + z);
+        });
+        if (std::fwrite(row.data(), 1, row.size(), file.get()) != row.size()) {
+            return false;
+        }
+        TraceLog(LOG_INFO, "ATLAS: baked row %d/%d", z + 1, depth);
+    }
+    return std::fflush(file.get()) == 0;
+}
+
+bool open(std::string_view path) {
+    cleanup();
+    const int fd = ::open(std::string(path).c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info = {};
+    const bool has_size = ::fstat(fd, &info) == 0 && static_cast<size_t>(info.st_size) >= sizeof(Header);
+    void *mapping = has_size ? ::mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+    ::close(fd); // the mapping keeps its own reference to the file
+    if (mapping == MAP_FAILED) {
+        return false;
+    }
+
+    Header header = {};
+    std::memcpy(&header, mapping, sizeof(header));
+    const TileLayout layout = get_tile_layout(header.resolution);
+    const bool compatible = header.magic == MAGIC && header.resolution == Terrain::get_chunk_resolution() && header.chunk_size == Terrain::get_chunk_size() && header.width > 0 && header.depth > 0;
+    const size_t expected_size = sizeof(Header) + layout.size * static_cast<size_t>(header.width) * static_cast<size_t>(header.depth);
+    if (!compatible || static_cast<size_t>(info.st_size) != expected_size) {
+        ::munmap(mapping, static_cast<size_t>(info.st_size));
+        return false;
+    }
+
+    internal_state = {
+        .mapping = static_cast<const std::byte *>(mapping),
+        .mapping_size = static_cast<size_t>(info.st_size),
+        .header = header,
+        .layout = layout,
+    };
+    TraceLog(LOG_INFO, "ATLAS: mapped %dx%d chunks from %d,%d", header.width, header.depth, header.min_cx, header.min_cz);
+    return true;
+}
+
+std::optional<Tile> find_tile(int32_t cx, int32_t cz) {
+    const auto &s = internal_state;
+    if (s.mapping == nullptr) {
+        return std::nullopt;
+    }
+    const int32_t x = cx - s.header.min_cx;
+    const int32_t z = cz - s.header.min_cz;
+    if (x < 0 || z < 0 || x >= s.header.width || z >= s.header.depth) {
+        return std::nullopt;
+    }
+    const std::byte *tile = s.mapping + sizeof(Header) + s.layout.size * (static_cast<size_t>(z) * static_cast<size_t>(s.header.width) + static_cast<size_t>(x));
+    return Tile{
+        .vertices = reinterpret_cast<const float *>(tile),
+        .normals = reinterpret_cast<const float *>(tile + s.layout.normals_offset),
+        .colors = reinterpret_cast<const unsigned char *>(tile + s.layout.colors_offset),
+    };
+}
+
+void cleanup() {
+    if (internal_state.mapping != nullptr) {
+        // munmap takes a mutable pointer; the pages were only ever mapped read-only
+        ::munmap(const_cast<std::byte *>(internal_state.mapping), internal_state.mapping_size);
+    }
+    internal_state = {};
+}
+
+} // namespace Atlas
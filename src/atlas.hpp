@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+namespace Atlas {
+
+/** read-only view of one baked chunk, laid out exactly like the chunk mesh arrays */
+struct Tile {
+    const float *vertices;
+    const float *normals;
+    const unsigned char *colors;
+};
+
+/** bakes chunks [min_cx, min_cx + width) x [min_cz, min_cz + depth) into a tiled file, returns false on i/o failure */
+bool bake(std::string_view path, int32_t min_cx, int32_t min_cz, int32_t width, int32_t depth);
+
+/** memory-maps a baked file, returns false if it is missing or was baked with a different chunk layout */
+bool open(std::string_view path);
+
+/** returns the baked tile of chunk (cx, cz), or nullopt outside the baked region */
+std::optional<Tile> find_tile(int32_t cx, int32_t cz);
+
+/** unmaps the file (tiles handed out before must no longer be in use) */
+void cleanup();
+
+} // namespace Atlas
@@ -5,22 +5,35 @@
 #include "raymath.h"
 #include "terrain.hpp"
 
+#include <algorithm>
+#include <array>
 #include <cmath>
+#include <cstdint>
 
 namespace Cam {
 
-/** updates and returns the camera (follows the car) */
-inline Camera3D &update(float dt) {
-    static Camera3D camera = {
-        .position = {0.0f, 10.0f, 10.0f},
-        .target = {0.0f, 0.0f, 0.0f},
-        .up = {0.0f, 1.0f, 0.0f},
-        .fovy = 45.0f,
-        .projection = CAMERA_PERSPECTIVE,
-    };
+/** returns every player's camera as the last `update` left it (snapshots save and restore them here) */
+inline std::array<Camera3D, Car::MAX_PLAYERS> &get_cameras() {
+    static std::array<Camera3D, Car::MAX_PLAYERS> cameras = [] {
+        std::array<Camera3D, Car::MAX_PLAYERS> initial;
+        initial.fill({
+            .position = {0.0f, 10.0f, 10.0f},
+            .target = {0.0f, 0.0f, 0.0f},
+            .up = {0.0f, 1.0f, 0.0f},
+            .fovy = 45.0f,
+            .projection = CAMERA_PERSPECTIVE,
+        });
+        return initial;
+    }();
+    return cameras;
+}
+
+/** updates and returns `player`'s camera (follows their car) */
+inline Camera3D &update(float dt, int32_t player = 0) {
+    Camera3D &camera = get_cameras()[static_cast<size_t>(player)];
 
-    Vector3 car_pos = Car::get_position();
-    float car_heading = Car::get_heading();
+    Vector3 car_pos = Car::get_position(player);
+    float car_heading = Car::get_heading(player);
 
     Vector3 target_cam_pos = {
         car_pos.x - std::sin(car_heading) * 15.0f,
@@ -29,6 +42,20 @@ inline Camera3D &update(float dt) {
     };
     camera.position = Vector3Lerp(camera.position, target_cam_pos, dt * 3.0f);
 
+    // spring arm: hills between the car and the camera pull the camera in front of them, and the lerp above
+    // lets it ease back out once the view is clear
+    constexpr float PIVOT_HEIGHT = 1.5f;
+    constexpr float ARM_MARGIN = 1.0f;
+    const Vector3 pivot = {car_pos.x, car_pos.y + PIVOT_HEIGHT, car_pos.z};
+    const Vector3 arm = Vector3Subtract(camera.position, pivot);
+    const float arm_length = Vector3Length(arm);
+    if (arm_length > ARM_MARGIN) {
+        const Vector3 arm_dir = Vector3Scale(arm, 1.0f / arm_length);
+        if (const auto hit = Terrain::raycast(pivot, arm_dir, arm_length + ARM_MARGIN)) {
+            camera.position = Vector3Add(pivot, Vector3Scale(arm_dir, std::max(hit->distance - ARM_MARGIN, 0.0f)));
+        }
+    }
+
     float cam_terrain_h = Terrain::get_height(camera.position.x, camera.position.z);
     if (camera.position.y < cam_terrain_h + 2.0f) {
         camera.position.y = cam_terrain_h + 2.0f;
@@ -1,9 +1,13 @@
 #include "car.hpp"
+#include "landscape.hpp"
 #include "raylib.h"
-#include "rlgl.h"
+#include "raymath.h"
+#include "renderqueue.hpp"
 #include "terrain.hpp"
 
 #include <algorithm>
+#include <array>
+#include <cassert>
 #include <cmath>
 
 namespace {
@@ -13,6 +17,9 @@ constexpr float PHYS_BRAKE = 160.0f;    // braking/reverse force
 constexpr float PHYS_MAX_SPEED = 50.0f; // max speed
 constexpr float PHYS_DRAG = 0.98f;      // drag coefficient
 constexpr float PHYS_TURN_RATE = 2.0f;  // turn rate in rad/s
+constexpr float PHYS_BOUNCE = 0.3f;     // fraction of speed kept (reversed) after hitting a tree or bush
+
+constexpr Vector2 BODY_HALF_EXTENTS = {1.0f, 2.35f}; // footprint of the body and bumpers
 
 struct CarControls {
     float throttle; // -1.0 (brake/reverse) to 1.0 (accel)
@@ -38,6 +45,27 @@ struct CarState {
         {{1.0f, -0.3f, -1.5f}, 0.0f},  // BL
     };
     CarControls controls = {};
+};
+
+struct KeyBindings {
+    KeyboardKey left;
+    KeyboardKey right;
+    KeyboardKey throttle;
+    KeyboardKey brake;
+};
+
+// player one drives with wasd, player two with the arrow keys
+constexpr std::array<KeyBindings, Car::MAX_PLAYERS> KEY_BINDINGS = {{
+    {KEY_A, KEY_D, KEY_W, KEY_S},
+    {KEY_LEFT, KEY_RIGHT, KEY_UP, KEY_DOWN},
+}};
+
+// the second player starts beside the first, in the oncoming lane
+constexpr std::array<float, Car::MAX_PLAYERS> START_OFFSETS = {0.0f, -3.0f};
+
+struct CarsState {
+    std::array<CarState, Car::MAX_PLAYERS> cars = {};
+    int32_t player_count = 1;
     bool initialized = false;
 } internal_state;
 
@@ -46,26 +74,35 @@ void ensure_initialized() {
         return;
     }
     internal_state.initialized = true;
-    internal_state.pos = Terrain::get_start_position();
-    internal_state.heading = Terrain::get_start_heading();
+    const Vector3 start = Terrain::get_start_position();
+    for (size_t i = 0; i < internal_state.cars.size(); ++i) {
+        CarState &car = internal_state.cars[i];
+        car.pos = {start.x + START_OFFSETS[i], start.y, start.z};
+        car.heading = Terrain::get_start_heading();
+    }
+}
+
+CarState &get_car(int32_t player) {
+    ensure_initialized();
+    assert(player >= 0 && player < internal_state.player_count);
+    return internal_state.cars[static_cast<size_t>(player)];
 }
 
-void read_input() {
-    internal_state.controls = {};
-    if (IsKeyDown(KEY_D)) {
-        internal_state.controls.steer = 1.0f;
-    } else if (IsKeyDown(KEY_A)) {
-        internal_state.controls.steer = -1.0f;
+void read_input(CarState &car, const KeyBindings &keys) {
+    car.controls = {};
+    if (IsKeyDown(keys.right)) {
+        car.controls.steer = 1.0f;
+    } else if (IsKeyDown(keys.left)) {
+        car.controls.steer = -1.0f;
     }
-    if (IsKeyDown(KEY_W)) {
-        internal_state.controls.throttle = 1.0f;
-    } else if (IsKeyDown(KEY_S)) {
-        internal_state.controls.throttle = -1.0f;
+    if (IsKeyDown(keys.throttle)) {
+        car.controls.throttle = 1.0f;
+    } else if (IsKeyDown(keys.brake)) {
+        car.controls.throttle = -1.0f;
     }
 }
 
-void update_physics(float dt) {
-    auto &car = internal_state;
+void update_physics(CarState &car, float dt) {
     const auto &inputs = car.controls;
 
     // steering
@@ -96,6 +133,15 @@ void update_physics(float dt) {
     car.pos.x += car.vel.x * dt;
     car.pos.z += car.vel.z * dt;
 
+    // landscape collision: push the body out and bounce back when driving into the element
+    if (const auto contact = Landscape::collide({car.pos.x, car.pos.z}, BODY_HALF_EXTENTS, car.heading)) {
+        car.pos.x += contact->normal.x * contact->depth;
+        car.pos.z += contact->normal.y * contact->depth;
+        if (car.vel.x * contact->normal.x + car.vel.z * contact->normal.y < 0.0f) {
+            car.speed *= -PHYS_BOUNCE;
+        }
+    }
+
     // wheel steering animation
     constexpr float MAX_STEER_ANGLE = 0.52f;
     constexpr float STEER_LERP_RATE = 8.0f;
@@ -134,8 +180,7 @@ void update_physics(float dt) {
     car.roll += (std::atan2(right_h - left_h, 2.0f) - car.roll) * 15.0f * dt;
 }
 
-void draw_car() {
-    const auto &car = internal_state;
+void draw_car(const CarState &car) {
 
     const Color body_main = {180, 40, 45, 255};     // deep red
     const Color body_accent = {140, 30, 35, 255};   // darker red accent
@@ -144,118 +189,137 @@ void draw_car() {
     const Color headlight = {255, 250, 220, 255};   // warm headlights
     const Color taillight = {255, 40, 40, 255};     // red taillights
 
-    rlPushMatrix();
-    rlTranslatef(car.pos.x, car.pos.y, car.pos.z);
-    rlRotatef(car.heading * RAD2DEG, 0.0f, 1.0f, 0.0f);
-    rlRotatef(car.pitch * RAD2DEG, 1.0f, 0.0f, 0.0f);
-    rlRotatef(car.roll * RAD2DEG, 0.0f, 0.0f, 1.0f);
-
-    DrawCube({0.0f, 0.15f, 0.0f}, 1.8f, 0.25f, 4.2f, DARKGRAY);        // chassis
-    DrawCube({0.0f, 0.55f, 1.6f}, 1.9f, 0.5f, 1.2f, body_main);        // hood top
-    DrawCube({0.0f, 0.35f, 1.6f}, 1.95f, 0.15f, 1.25f, body_accent);   // hood lower
-    DrawCube({0.0f, 0.55f, 0.3f}, 1.9f, 0.5f, 1.4f, body_main);        // cab lower body
-    DrawCube({0.0f, 1.05f, 0.2f}, 1.7f, 0.5f, 1.2f, body_main);        // cab upper body (roof area)
-    DrawCube({0.0f, 1.35f, 0.2f}, 1.6f, 0.1f, 1.1f, body_accent);      // roof
-    DrawCube({0.0f, 1.0f, 0.87f}, 1.5f, 0.4f, 0.06f, window_tint);     // windshield
-    DrawCube({0.0f, 1.0f, -0.42f}, 1.5f, 0.35f, 0.06f, window_tint);   // rear window
-    DrawCube({-0.90f, 1.0f, 0.2f}, 0.06f, 0.35f, 0.8f, window_tint);   // left window
-    DrawCube({0.90f, 1.0f, 0.2f}, 0.06f, 0.35f, 0.8f, window_tint);    // right window
-    DrawCube({-0.82f, 1.0f, 0.65f}, 0.08f, 0.45f, 0.12f, body_accent); // left pillar
-    DrawCube({0.82f, 1.0f, 0.65f}, 0.08f, 0.45f, 0.12f, body_accent);  // right pillar (windshield frame)
-    DrawCube({0.0f, 0.4f, -1.3f}, 1.76f, 0.1f, 1.56f, body_accent);    // bed floor (hollow trunk)
-    DrawCube({-0.9f, 0.65f, -1.3f}, 0.12f, 0.45f, 1.6f, body_main);    // left bed wall
-    DrawCube({0.9f, 0.65f, -1.3f}, 0.12f, 0.45f, 1.6f, body_main);     // right bed wall
-    DrawCube({0.0f, 0.65f, -0.48f}, 1.76f, 0.45f, 0.12f, body_main);   // front bed wall (behind cab)
-    DrawCube({0.0f, 0.65f, -2.12f}, 1.8f, 0.45f, 0.1f, body_main);     // tailgate (rear)
-    DrawCube({-0.9f, 0.92f, -1.3f}, 0.14f, 0.04f, 1.58f, trim_chrome); // bed left wall trim
-    DrawCube({0.9f, 0.92f, -1.3f}, 0.14f, 0.04f, 1.58f, trim_chrome);  // bed right wall trim
-    DrawCube({0.0f, 0.92f, -2.12f}, 1.76f, 0.04f, 0.10f, trim_chrome); // bed front wall trim
+    // parts are queued with their full world transform (roll, then pitch, then heading, then position),
+    // so the queue can sort each one on its own
+    const Matrix body = MatrixMultiply(MatrixMultiply(MatrixMultiply(MatrixRotateZ(car.roll), MatrixRotateX(car.pitch)), MatrixRotateY(car.heading)), MatrixTranslate(car.pos.x, car.pos.y, car.pos.z));
+    const auto cube = [&](Vector3 center, float width, float height, float length, Color color) { RenderQueue::submit_cube(MatrixMultiply(MatrixTranslate(center.x, center.y, center.z), body), {width, height, length}, color); };
+
+    cube({0.0f, 0.15f, 0.0f}, 1.8f, 0.25f, 4.2f, DARKGRAY);        // chassis
+    cube({0.0f, 0.55f, 1.6f}, 1.9f, 0.5f, 1.2f, body_main);        // hood top
+    cube({0.0f, 0.35f, 1.6f}, 1.95f, 0.15f, 1.25f, body_accent);   // hood lower
+    cube({0.0f, 0.55f, 0.3f}, 1.9f, 0.5f, 1.4f, body_main);        // cab lower body
+    cube({0.0f, 1.05f, 0.2f}, 1.7f, 0.5f, 1.2f, body_main);        // cab upper body (roof area)
+    cube({0.0f, 1.35f, 0.2f}, 1.6f, 0.1f, 1.1f, body_accent);      // roof
+    cube({0.0f, 1.0f, 0.87f}, 1.5f, 0.4f, 0.06f, window_tint);     // windshield
+    cube({0.0f, 1.0f, -0.42f}, 1.5f, 0.35f, 0.06f, window_tint);   // rear window
+    cube({-0.90f, 1.0f, 0.2f}, 0.06f, 0.35f, 0.8f, window_tint);   // left window
+    cube({0.90f, 1.0f, 0.2f}, 0.06f, 0.35f, 0.8f, window_tint);    // right window
+    cube({-0.82f, 1.0f, 0.65f}, 0.08f, 0.45f, 0.12f, body_accent); // left pillar
+    cube({0.82f, 1.0f, 0.65f}, 0.08f, 0.45f, 0.12f, body_accent);  // right pillar (windshield frame)
+    cube({0.0f, 0.4f, -1.3f}, 1.76f, 0.1f, 1.56f, body_accent);    // bed floor (hollow trunk)
+    cube({-0.9f, 0.65f, -1.3f}, 0.12f, 0.45f, 1.6f, body_main);    // left bed wall
+    cube({0.9f, 0.65f, -1.3f}, 0.12f, 0.45f, 1.6f, body_main);     // right bed wall
+    cube({0.0f, 0.65f, -0.48f}, 1.76f, 0.45f, 0.12f, body_main);   // front bed wall (behind cab)
+    cube({0.0f, 0.65f, -2.12f}, 1.8f, 0.45f, 0.1f, body_main);     // tailgate (rear)
+    cube({-0.9f, 0.92f, -1.3f}, 0.14f, 0.04f, 1.58f, trim_chrome); // bed left wall trim
+    cube({0.9f, 0.92f, -1.3f}, 0.14f, 0.04f, 1.58f, trim_chrome);  // bed right wall trim
+    cube({0.0f, 0.92f, -2.12f}, 1.76f, 0.04f, 0.10f, trim_chrome); // bed front wall trim
     // front wheel arches
-    DrawCube({-1.01f, 0.35f, 1.5f}, 0.12f, 0.4f, 0.7f, body_accent);
-    DrawCube({1.01f, 0.35f, 1.5f}, 0.12f, 0.4f, 0.7f, body_accent);
+    cube({-1.01f, 0.35f, 1.5f}, 0.12f, 0.4f, 0.7f, body_accent);
+    cube({1.01f, 0.35f, 1.5f}, 0.12f, 0.4f, 0.7f, body_accent);
     // rear wheel arches
-    DrawCube({-1.01f, 0.35f, -1.5f}, 0.12f, 0.4f, 0.7f, body_accent);
-    DrawCube({1.01f, 0.35f, -1.5f}, 0.12f, 0.4f, 0.7f, body_accent);
+    cube({-1.01f, 0.35f, -1.5f}, 0.12f, 0.4f, 0.7f, body_accent);
+    cube({1.01f, 0.35f, -1.5f}, 0.12f, 0.4f, 0.7f, body_accent);
     // front bumper
-    DrawCube({0.0f, 0.25f, 2.28f}, 2.0f, 0.25f, 0.15f, trim_chrome);
-    DrawCube({0.0f, 0.16f, 2.34f}, 1.8f, 0.1f, 0.08f, DARKGRAY);
+    cube({0.0f, 0.25f, 2.28f}, 2.0f, 0.25f, 0.15f, trim_chrome);
+    cube({0.0f, 0.16f, 2.34f}, 1.8f, 0.1f, 0.08f, DARKGRAY);
     // grille
-    DrawCube({0.0f, 0.5f, 2.24f}, 1.0f, 0.3f, 0.05f, trim_chrome);
+    cube({0.0f, 0.5f, 2.24f}, 1.0f, 0.3f, 0.05f, trim_chrome);
     // grille slats
     for (int i = 0; i < 5; i++) {
         float y_off = 0.42f + static_cast<float>(i) * 0.05f;
-        DrawCube({0.0f, y_off, 2.28f}, 0.9f, 0.02f, 0.02f, DARKGRAY);
+        cube({0.0f, y_off, 2.28f}, 0.9f, 0.02f, 0.02f, DARKGRAY);
     }
     // headlight
-    DrawCube({-0.7f, 0.5f, 2.26f}, 0.3f, 0.2f, 0.04f, headlight);
-    DrawCube({0.7f, 0.5f, 2.26f}, 0.3f, 0.2f, 0.04f, headlight);
+    cube({-0.7f, 0.5f, 2.26f}, 0.3f, 0.2f, 0.04f, headlight);
+    cube({0.7f, 0.5f, 2.26f}, 0.3f, 0.2f, 0.04f, headlight);
     // turn signals
-    DrawCube({-0.95f, 0.5f, 2.20f}, 0.12f, 0.12f, 0.04f, ORANGE);
-    DrawCube({0.95f, 0.5f, 2.20f}, 0.12f, 0.12f, 0.04f, ORANGE);
+    cube({-0.95f, 0.5f, 2.20f}, 0.12f, 0.12f, 0.04f, ORANGE);
+    cube({0.95f, 0.5f, 2.20f}, 0.12f, 0.12f, 0.04f, ORANGE);
     // rear bumper
-    DrawCube({0.0f, 0.25f, -2.28f}, 2.0f, 0.2f, 0.12f, trim_chrome);
+    cube({0.0f, 0.25f, -2.28f}, 2.0f, 0.2f, 0.12f, trim_chrome);
     // taillight
-    DrawCube({-0.75f, 0.65f, -2.18f}, 0.25f, 0.2f, 0.04f, taillight);
-    DrawCube({0.75f, 0.65f, -2.18f}, 0.25f, 0.2f, 0.04f, taillight);
+    cube({-0.75f, 0.65f, -2.18f}, 0.25f, 0.2f, 0.04f, taillight);
+    cube({0.75f, 0.65f, -2.18f}, 0.25f, 0.2f, 0.04f, taillight);
     // reverse lights
-    DrawCube({-0.45f, 0.65f, -2.18f}, 0.1f, 0.12f, 0.04f, WHITE);
-    DrawCube({0.45f, 0.65f, -2.18f}, 0.1f, 0.12f, 0.04f, WHITE);
+    cube({-0.45f, 0.65f, -2.18f}, 0.1f, 0.12f, 0.04f, WHITE);
+    cube({0.45f, 0.65f, -2.18f}, 0.1f, 0.12f, 0.04f, WHITE);
     // side mirror arms
-    DrawCube({-1.08f, 0.95f, 0.7f}, 0.12f, 0.05f, 0.1f, body_accent);
-    DrawCube({1.08f, 0.95f, 0.7f}, 0.12f, 0.05f, 0.1f, body_accent);
+    cube({-1.08f, 0.95f, 0.7f}, 0.12f, 0.05f, 0.1f, body_accent);
+    cube({1.08f, 0.95f, 0.7f}, 0.12f, 0.05f, 0.1f, body_accent);
     // mirror housings
-    DrawCube({-1.20f, 0.95f, 0.7f}, 0.08f, 0.12f, 0.18f, body_accent);
-    DrawCube({1.20f, 0.95f, 0.7f}, 0.08f, 0.12f, 0.18f, body_accent);
+    cube({-1.20f, 0.95f, 0.7f}, 0.08f, 0.12f, 0.18f, body_accent);
+    cube({1.20f, 0.95f, 0.7f}, 0.08f, 0.12f, 0.18f, body_accent);
     // mirror glass
-    DrawCube({-1.26f, 0.95f, 0.7f}, 0.02f, 0.1f, 0.15f, {100, 120, 140, 200});
-    DrawCube({1.26f, 0.95f, 0.7f}, 0.02f, 0.1f, 0.15f, {100, 120, 140, 200});
+    cube({-1.26f, 0.95f, 0.7f}, 0.02f, 0.1f, 0.15f, {100, 120, 140, 200});
+    cube({1.26f, 0.95f, 0.7f}, 0.02f, 0.1f, 0.15f, {100, 120, 140, 200});
     // door handles
-    DrawCube({-0.98f, 0.75f, 0.35f}, 0.02f, 0.04f, 0.12f, trim_chrome);
-    DrawCube({0.98f, 0.75f, 0.35f}, 0.02f, 0.04f, 0.12f, trim_chrome);
+    cube({-0.98f, 0.75f, 0.35f}, 0.02f, 0.04f, 0.12f, trim_chrome);
+    cube({0.98f, 0.75f, 0.35f}, 0.02f, 0.04f, 0.12f, trim_chrome);
     // wheels
-    DrawCube({-0.98f, 0.75f, 0.35f}, 0.02f, 0.04f, 0.12f, trim_chrome);
-    DrawCube({0.98f, 0.75f, 0.35f}, 0.02f, 0.04f, 0.12f, trim_chrome);
+    cube({-0.98f, 0.75f, 0.35f}, 0.02f, 0.04f, 0.12f, trim_chrome);
+    cube({0.98f, 0.75f, 0.35f}, 0.02f, 0.04f, 0.12f, trim_chrome);
 
     // wheels
     for (int i = 0; i < 4; i++) {
-        rlPushMatrix();
-        rlTranslatef(car.wheels[i].local_offset.x, car.wheels[i].local_offset.y, car.wheels[i].local_offset.z);
-        if (i < 2) {
-            rlRotatef(car.wheels[i].steering_angle * RAD2DEG, 0.0f, 1.0f, 0.0f);
-        }
+        const Vector3 offset = car.wheels[i].local_offset;
+        const Matrix steer = (i < 2) ? MatrixRotateY(car.wheels[i].steering_angle) : MatrixIdentity();
+        const Matrix wheel = MatrixMultiply(MatrixMultiply(steer, MatrixTranslate(offset.x, offset.y, offset.z)), body);
         // simple tire
-        DrawCylinderEx({-0.18f, 0.0f, 0.0f}, {0.18f, 0.0f, 0.0f}, 0.36f, 0.36f, 12, DARKGRAY);
-        rlPopMatrix();
+        RenderQueue::submit_cylinder(Vector3Transform({-0.18f, 0.0f, 0.0f}, wheel), Vector3Transform({0.18f, 0.0f, 0.0f}, wheel), 0.36f, 0.36f, 12, DARKGRAY);
     }
-
-    rlPopMatrix();
 }
 
 } // namespace
 
 namespace Car {
 
+void set_player_count(int32_t count) {
+    assert(count >= 1 && count <= MAX_PLAYERS);
+    internal_state.player_count = count;
+}
+
+int32_t get_player_count() { return internal_state.player_count; }
+
 void update(float dt) {
     ensure_initialized();
-    read_input();
-    Terrain::update(internal_state.pos);
-    update_physics(dt);
-    draw_car();
+    for (int32_t player = 0; player < internal_state.player_count; ++player) {
+        CarState &car = get_car(player);
+        read_input(car, KEY_BINDINGS[static_cast<size_t>(player)]);
+        update_physics(car, dt);
+    }
 }
 
-Vector3 get_position() {
+void draw() {
     ensure_initialized();
-    return internal_state.pos;
+    for (int32_t player = 0; player < internal_state.player_count; ++player) {
+        draw_car(get_car(player));
+    }
 }
 
-float get_heading() {
+Vector3 get_position(int32_t player) { return get_car(player).pos; }
+
+float get_heading(int32_t player) { return get_car(player).heading; }
+
+float get_speed(int32_t player) { return get_car(player).speed; }
+
+void save(Snapshot::Writer &writer) {
     ensure_initialized();
-    return internal_state.heading;
+    // the layout size guards against snapshots written by a build with a different car state
+    writer.write(static_cast<uint32_t>(sizeof(internal_state.cars)));
+    writer.write(internal_state.cars);
 }
 
-float get_speed() {
-    ensure_initialized();
-    return internal_state.speed;
+Snapshot::Restore load(Snapshot::Reader &reader) {
+    uint32_t size = 0;
+    std::array<CarState, MAX_PLAYERS> cars = {};
+    if (!reader.read(size) || size != sizeof(cars) || !reader.read(cars)) {
+        return {};
+    }
+    return [cars] {
+        internal_state.cars = cars;
+        internal_state.initialized = true;
+    };
 }
 
 } // namespace Car
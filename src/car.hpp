@@ -1,23 +1,43 @@
 #pragma once
 
 #include "raylib.h"
+#include "snapshot.hpp"
+#include <cstdint>
 
 namespace Car {
 
-/** reads input, updates physics, and draws the car */
+constexpr int32_t MAX_PLAYERS = 2;
+
+/** sets how many cars are driven locally (1 or 2); the second one steers with the arrow keys */
+void set_player_count(int32_t count);
+
+/** reads input and updates physics for every player's car */
 void update(float dt);
 
+/** queues every player's car for drawing */
+void draw();
+
+/** appends the state of every car, driven or not, to `writer` */
+void save(Snapshot::Writer &writer);
+
+/** reads the cars `save` wrote and returns what restores them (the player count stays as configured); empty if the
+    data does not match this build's car state */
+Snapshot::Restore load(Snapshot::Reader &reader);
+
 //
 // getters
 //
 
-/** returns the current car position */
-Vector3 get_position();
+/** returns the number of locally driven cars */
+int32_t get_player_count();
+
+/** returns the current position of `player`'s car */
+Vector3 get_position(int32_t player = 0);
 
-/** returns the current car heading (radians) */
-float get_heading();
+/** returns the current heading of `player`'s car (radians) */
+float get_heading(int32_t player = 0);
 
-/** returns the current car speed */
-float get_speed();
+/** returns the current speed of `player`'s car */
+float get_speed(int32_t player = 0);
 
 } // namespace Car
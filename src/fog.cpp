@@ -0,0 +1,112 @@
+#include "fog.hpp"
+#include "glsl.hpp"
+
+#include <cassert>
+#include <cmath>
+
+namespace {
+
+constexpr float EDGE_FOG = 0.85f; // fog at the view distance: chunks streaming in there are barely visible
+constexpr float CULL_FOG = 0.99f;
+constexpr Color FOG_COLOR = SKYBLUE; // matches the cleared background
+
+// raylib's default batch shader plus the fog term
+constexpr const char *BATCH_VS = GLSL_VERSION FOG_GLSL R"(
+in_attr vec3 vertexPosition;
+in_attr vec2 vertexTexCoord;
+in_attr vec4 vertexColor;
+uniform mat4 mvp;
+out_var vec2 fragTexCoord;
+out_var vec4 fragColor;
+out_var float fragFog;
+void main() {
+    fragTexCoord = vertexTexCoord;
+    fragColor = vertexColor;
+    fragFog = fog_factor(vertexPosition);
+    gl_Position = mvp * vec4(vertexPosition, 1.0);
+}
+)";
+
+constexpr const char *BATCH_FS = GLSL_VERSION GLSL_FRAG_OUT R"(
+in_var vec2 fragTexCoord;
+in_var vec4 fragColor;
+in_var float fragFog;
+uniform sampler2D texture0;
+uniform vec4 colDiffuse;
+uniform vec3 fogColor;
+void main() {
+    vec4 base = texture(texture0, fragTexCoord) * colDiffuse * fragColor;
+    FRAG_COLOR = vec4(mix(base.rgb, fogColor, fragFog), base.a);
+}
+)";
+
+struct FogState {
+    Shader shader = {};
+    Vector3 eye = {};
+    float density = 0.0f; // zero until configured: no fog
+    bool initialized = false;
+} internal_state;
+
+void ensure_initialized() {
+    auto &s = internal_state;
+    if (s.initialized) {
+        return;
+    }
+    s.initialized = true;
+    if (IsWindowReady()) {
+        s.shader = LoadShaderFromMemory(BATCH_VS, BATCH_FS);
+    }
+}
+
+} // namespace
+
+namespace Fog {
+
+void configure(float view_distance) {
+    assert(view_distance > 0.0f);
+    // exponential squared: clear near the eye, then closing in quickly towards the edge
+    internal_state.density = std::sqrt(-std::log(1.0f - EDGE_FOG)) / view_distance;
+}
+
+void update(const Camera3D &camera) {
+    ensure_initialized();
+    internal_state.eye = camera.position;
+    if (internal_state.shader.id != 0) {
+        apply(internal_state.shader);
+    }
+}
+
+void apply(const Shader &shader) {
+    const auto &s = internal_state;
+    const Vector3 color = {FOG_COLOR.r / 255.0f, FOG_COLOR.g / 255.0f, FOG_COLOR.b / 255.0f};
+    SetShaderValue(shader, GetShaderLocation(shader, "fogEye"), &s.eye, SHADER_UNIFORM_VEC3);
+    SetShaderValue(shader, GetShaderLocation(shader, "fogDensity"), &s.density, SHADER_UNIFORM_FLOAT);
+    SetShaderValue(shader, GetShaderLocation(shader, "fogColor"), &color, SHADER_UNIFORM_VEC3);
+}
+
+float get_factor(float distance) {
+    const float d = distance * internal_state.density;
+    return 1.0f - std::exp(-d * d);
+}
+
+float get_cull_distance() {
+    const float density = internal_state.density;
+    return density > 0.0f ? std::sqrt(-std::log(1.0f - CULL_FOG)) / density : INFINITY;
+}
+
+Color get_color() { return FOG_COLOR; }
+
+Shader get_shader() {
+    ensure_initialized();
+    return internal_state.shader;
+}
+
+void cleanup() {
+    auto &s = internal_state;
+    if (s.shader.id != 0) {
+        UnloadShader(s.shader);
+    }
+    s = {};
+}
+
+} // namespace Fog
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "raylib.h"
+
+// vertex-stage fog term shared by every fogged shader; positions are world-space
+#define FOG_GLSL "uniform vec3 fogEye;\nuniform float fogDensity;\nfloat fog_factor(vec3 position) { float d = distance(position, fogEye) * fogDensity; return 1.0 - exp(-d * d); }\n"
+
+namespace Fog {
+
+/** scales the fog so it is nearly opaque at `view_distance`, the radius the terrain is guaranteed to cover */
+void configure(float view_distance);
+
+/** moves the fog with the camera and uploads it to the batch shader */
+void update(const Camera3D &camera);
+
+/** uploads the fog uniforms (`fogEye`, `fogDensity`, `fogColor`) to a shader built with `FOG_GLSL` */
+void apply(const Shader &shader);
+
+//
+// getters
+//
+
+/** returns how much of the fog color replaces a surface `distance` units from the eye, in [0, 1] */
+float get_factor(float distance);
+
+/** returns the distance beyond which surfaces are indistinguishable from the fog */
+float get_cull_distance();
+
+/** returns the color surfaces fade to */
+Color get_color();
+
+/** returns the fogged variant of raylib's batch shader (vertex colors, diffuse texture) */
+Shader get_shader();
+
+/** frees the batch shader */
+void cleanup();
+
+} // namespace Fog
@@ -0,0 +1,39 @@
+#include "frustum.hpp"
+#include "raymath.h"
+#include "rlgl.h"
+
+#include <cmath>
+
+namespace Frustum {
+
+Volume from_camera(const Camera3D &camera, float aspect) {
+    const Vector3 forward = Vector3Normalize(Vector3Subtract(camera.target, camera.position));
+    const Vector3 right = Vector3Normalize(Vector3CrossProduct(forward, camera.up));
+    const Vector3 up = Vector3CrossProduct(right, forward);
+    const float half_v = camera.fovy * 0.5f * DEG2RAD;
+    const float half_h = std::atan(std::tan(half_v) * aspect);
+
+    // each side plane contains the eye; its normal leans from the side axis towards the view direction
+    const auto plane = [&](Vector3 side, float half_angle) {
+        const Vector3 n = Vector3Add(Vector3Scale(forward, std::sin(half_angle)), Vector3Scale(side, std::cos(half_angle)));
+        return Vector4{n.x, n.y, n.z, -Vector3DotProduct(n, camera.position)};
+    };
+    return {.planes = {plane(right, half_h), plane(Vector3Negate(right), half_h), plane(up, half_v), plane(Vector3Negate(up), half_v)}};
+}
+
+float get_current_aspect() {
+    // BeginMode3D's perspective keeps f / aspect in m0 and f in m5
+    const Matrix projection = rlGetMatrixProjection();
+    return projection.m0 != 0.0f ? projection.m5 / projection.m0 : 1.0f;
+}
+
+bool intersects_sphere(const Volume &volume, Vector3 center, float radius) {
+    for (const Vector4 &p : volume.planes) {
+        if (p.x * center.x + p.y * center.y + p.z * center.z + p.w < -radius) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace Frustum
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "raylib.h"
+#include <array>
+
+namespace Frustum {
+
+/** the side planes of a perspective view; distance is left to the fog's cull distance */
+struct Volume {
+    std::array<Vector4, 4> planes; // xyz inward normal, w offset: inside when dot(n, p) + w >= 0
+};
+
+/** builds the view volume of `camera` for a target `aspect` (width over height) */
+Volume from_camera(const Camera3D &camera, float aspect);
+
+/** returns the aspect of the projection set by the active BeginMode3D */
+float get_current_aspect();
+
+/** returns whether a sphere reaches into the volume (conservative) */
+bool intersects_sphere(const Volume &volume, Vector3 center, float radius);
+
+} // namespace Frustum
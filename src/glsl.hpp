@@ -0,0 +1,10 @@
+#pragma once
+
+// shader sources are written once against these macros: webgl only speaks glsl 100, desktop gets 330
+#if defined(__EMSCRIPTEN__)
+#define GLSL_VERSION "#version 100\nprecision mediump float;\n#define in_attr attribute\n#define in_var varying\n#define out_var varying\n#define texture texture2D\n#define FRAG_COLOR gl_FragColor\n"
+#define GLSL_FRAG_OUT ""
+#else
+#define GLSL_VERSION "#version 330\n#define in_attr in\n#define in_var in\n#define out_var out\n"
+#define GLSL_FRAG_OUT "out vec4 FRAG_COLOR;\n"
+#endif
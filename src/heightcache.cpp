@@ -0,0 +1,239 @@
+#include "heightcache.hpp"
+#include "terrain.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+namespace {
+
+constexpr size_t BUDGET_BYTES = 4 * 1024 * 1024;
+constexpr int32_t INDEX_SIZE = 64; // direct-mapped by chunk coordinate, so lookups never search
+
+struct Entry {
+    int32_t cx;
+    int32_t cz;
+    uint64_t last_used;
+    float base;
+    float scale;
+    bool valid;
+};
+
+struct HeightCacheState {
+    HeightCache::Encoding encoding = HeightCache::Encoding::OFF;
+    int32_t resolution = 0;
+    float chunk_size = 0.0f;
+    size_t stride = 0;
+    std::vector<std::byte> payload; // allocated once per configure, entries never grow
+    std::vector<Entry> entries;
+    std::array<int32_t, INDEX_SIZE * INDEX_SIZE> index = {};
+    uint64_t clock = 0;
+} internal_state;
+
+size_t get_stride(HeightCache::Encoding encoding, int32_t resolution) {
+    const auto n = static_cast<size_t>(resolution);
+    switch (encoding) {
+    case HeightCache::Encoding::OFF:
+        return 0;
+    case HeightCache::Encoding::FLOAT32:
+        return n * n * sizeof(float);
+    case HeightCache::Encoding::QUANTIZED16:
+        return n * n * sizeof(uint16_t);
+    case HeightCache::Encoding::DELTA8:
+        return n * sizeof(float) + n * (n - 1) * sizeof(int8_t);
+    }
+    return 0;
+}
+
+size_t get_index_slot(int32_t cx, int32_t cz) { return static_cast<size_t>((cz & (INDEX_SIZE - 1)) * INDEX_SIZE + (cx & (INDEX_SIZE - 1))); }
+
+void evict(int32_t entry) {
+    auto &s = internal_state;
+    Entry &e = s.entries[static_cast<size_t>(entry)];
+    if (e.valid && s.index[get_index_slot(e.cx, e.cz)] == entry) {
+        s.index[get_index_slot(e.cx, e.cz)] = -1;
+    }
+    e.valid = false;
+}
+
+Entry encode(std::byte *out, int32_t cx, int32_t cz, const float *vertices) {
+    const auto &s = internal_state;
+    const auto n = static_cast<size_t>(s.resolution);
+    const auto height = [&](size_t x, size_t z) { return vertices[(z * n + x) * 3 + 1]; };
+    Entry e = {.cx = cx, .cz = cz, .last_used = s.clock, .base = 0.0f, .scale = 1.0f, .valid = true};
+
+    switch (s.encoding) {
+    case HeightCache::Encoding::OFF:
+        break;
+    case HeightCache::Encoding::FLOAT32: {
+        auto *dst = reinterpret_cast<float *>(out);
+        for (size_t i = 0; i < n * n; ++i) {
+            dst[i] = vertices[i * 3 + 1];
+        }
+        break;
+    }
+    case HeightCache::Encoding::QUANTIZED16: {
+        float lo = std::numeric_limits<float>::max();
+        float hi = std::numeric_limits<float>::lowest();
+        for (size_t i = 0; i < n * n; ++i) {
+            lo = std::min(lo, vertices[i * 3 + 1]);
+            hi = std::max(hi, vertices[i * 3 + 1]);
+        }
+        e.base = lo;
+        e.scale = std::max(hi - lo, 1e-6f) / 65535.0f;
+        auto *dst = reinterpret_cast<uint16_t *>(out);
+        for (size_t i = 0; i < n * n; ++i) {
+            dst[i] = static_cast<uint16_t>(std::lround((vertices[i * 3 + 1] - e.base) / e.scale));
+        }
+        break;
+    }
+    case HeightCache::Encoding::DELTA8: {
+        // the step is sized so the steepest neighbour delta fits in int8; encoding against the
+        // reconstructed value keeps the error at half a step instead of letting it drift along the row
+        float steepest = 0.0f;
+        for (size_t z = 0; z < n; ++z) {
+            for (size_t x = 1; x < n; ++x) {
+                steepest = std::max(steepest, std::abs(height(x, z) - height(x - 1, z)));
+            }
+        }
+        e.scale = std::max(steepest, 1e-6f) / 127.0f;
+        auto *seeds = reinterpret_cast<float *>(out);
+        auto *deltas = reinterpret_cast<int8_t *>(out + n * sizeof(float));
+        for (size_t z = 0; z < n; ++z) {
+            seeds[z] = height(0, z);
+            float reconstructed = seeds[z];
+            for (size_t x = 1; x < n; ++x) {
+                const int32_t step = std::clamp(static_cast<int32_t>(std::lround((height(x, z) - reconstructed) / e.scale)), int32_t{-127}, int32_t{127});
+                deltas[z * (n - 1) + x - 1] = static_cast<int8_t>(step);
+                reconstructed += static_cast<float>(step) * e.scale;
+            }
+        }
+        break;
+    }
+    }
+    return e;
+}
+
+float decode(const std::byte *in, const Entry &e, size_t x, size_t z) {
+    const auto n = static_cast<size_t>(internal_state.resolution);
+    switch (internal_state.encoding) {
+    case HeightCache::Encoding::OFF:
+        return 0.0f;
+    case HeightCache::Encoding::FLOAT32:
+        return reinterpret_cast<const float *>(in)[z * n + x];
+    case HeightCache::Encoding::QUANTIZED16:
+        return e.base + static_cast<float>(reinterpret_cast<const uint16_t *>(in)[z * n + x]) * e.scale;
+    case HeightCache::Encoding::DELTA8: {
+        const auto *deltas = reinterpret_cast<const int8_t *>(in + n * sizeof(float)) + z * (n - 1);
+        int32_t sum = 0;
+        for (size_t i = 0; i < x; ++i) {
+            sum += deltas[i];
+        }
+        return reinterpret_cast<const float *>(in)[z] + static_cast<float>(sum) * e.scale;
+    }
+    }
+    return 0.0f;
+}
+
+} // namespace
+
+namespace HeightCache {
+
+void configure(Encoding encoding) {
+    cleanup();
+    auto &s = internal_state;
+    s.encoding = encoding;
+    if (encoding == Encoding::OFF) {
+        return;
+    }
+    s.resolution = Terrain::get_chunk_resolution();
+    s.chunk_size = Terrain::get_chunk_size();
+    s.stride = get_stride(encoding, s.resolution);
+    const size_t capacity = BUDGET_BYTES / s.stride;
+    s.payload.resize(capacity * s.stride);
+    s.entries.assign(capacity, Entry{});
+}
+
+Encoding get_encoding() { return internal_state.encoding; }
+
+void store(int32_t cx, int32_t cz, const float *vertices) {
+    auto &s = internal_state;
+    if (s.encoding == Encoding::OFF) {
+        return;
+    }
+    ++s.clock;
+
+    // an occupied index slot (same chunk, or one INDEX_SIZE chunks away) is reused, otherwise the least recently used entry
+    const size_t slot = get_index_slot(cx, cz);
+    int32_t target = s.index[slot];
+    if (target < 0) {
+        const auto lru = std::ranges::min_element(s.entries, [](const Entry &a, const Entry &b) { return (a.valid ? a.last_used + 1 : 0) < (b.valid ? b.last_used + 1 : 0); });
+        target = static_cast<int32_t>(lru - s.entries.begin());
+    }
+    evict(target);
+
+    std::byte *out = s.payload.data() + static_cast<size_t>(target) * s.stride;
+    s.entries[static_cast<size_t>(target)] = encode(out, cx, cz, vertices);
+    s.index[slot] = target;
+}
+
+void touch(int32_t cx, int32_t cz) {
+    auto &s = internal_state;
+    if (s.encoding == Encoding::OFF) {
+        return;
+    }
+    const int32_t entry = s.index[get_index_slot(cx, cz)];
+    if (entry >= 0 && s.entries[static_cast<size_t>(entry)].cx == cx && s.entries[static_cast<size_t>(entry)].cz == cz) {
+        s.entries[static_cast<size_t>(entry)].last_used = ++s.clock;
+    }
+}
+
+std::optional<float> sample(float x, float z) {
+    const auto &s = internal_state;
+    if (s.encoding == Encoding::OFF) {
+        return std::nullopt;
+    }
+    const auto cx = static_cast<int32_t>(std::floor(x / s.chunk_size));
+    const auto cz = static_cast<int32_t>(std::floor(z / s.chunk_size));
+    const int32_t entry = s.index[get_index_slot(cx, cz)];
+    if (entry < 0) {
+        return std::nullopt;
+    }
+    const Entry &e = s.entries[static_cast<size_t>(entry)];
+    if (e.cx != cx || e.cz != cz) {
+        return std::nullopt;
+    }
+
+    // interpolate on the same two triangles per quad the chunk mesh renders (split along tr-bl)
+    const float tile = s.chunk_size / static_cast<float>(s.resolution - 1);
+    const float gx = (x - static_cast<float>(cx) * s.chunk_size) / tile;
+    const float gz = (z - static_cast<float>(cz) * s.chunk_size) / tile;
+    const auto ix = static_cast<size_t>(std::clamp(static_cast<int32_t>(gx), 0, s.resolution - 2));
+    const auto iz = static_cast<size_t>(std::clamp(static_cast<int32_t>(gz), 0, s.resolution - 2));
+    const float fx = gx - static_cast<float>(ix);
+    const float fz = gz - static_cast<float>(iz);
+    const std::byte *in = s.payload.data() + static_cast<size_t>(entry) * s.stride;
+    const float tr = decode(in, e, ix + 1, iz);
+    const float bl = decode(in, e, ix, iz + 1);
+    if (fx + fz <= 1.0f) {
+        const float tl = decode(in, e, ix, iz);
+        return tl + fx * (tr - tl) + fz * (bl - tl);
+    }
+    const float br = decode(in, e, ix + 1, iz + 1);
+    return br + (1.0f - fx) * (bl - br) + (1.0f - fz) * (tr - br);
+}
+
+int32_t get_capacity() { return static_cast<int32_t>(internal_state.entries.size()); }
+
+void cleanup() {
+    internal_state = {};
+    internal_state.index.fill(-1);
+}
+
+} // namespace HeightCache
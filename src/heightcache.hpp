@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+
+namespace HeightCache {
+
+/** storage format of cached chunk heightfields */
+enum class Encoding {
+    OFF,         // get_height always evaluates noise
+    FLOAT32,     // raw heights, 16 KB per chunk
+    QUANTIZED16, // 16-bit offsets from a per-chunk base and scale, 8 KB per chunk
+    DELTA8,      // per-row seed plus 8-bit deltas, ~4 KB per chunk
+};
+
+/** (re)creates the cache with a fixed memory budget, dropping everything cached so far */
+void configure(Encoding encoding);
+
+/** returns the active encoding */
+Encoding get_encoding();
+
+/** encodes the heights of a freshly generated chunk (vertices as in the chunk mesh, heights in y) */
+void store(int32_t cx, int32_t cz, const float *vertices);
+
+/** marks a chunk as used in the current streaming window so it is evicted last */
+void touch(int32_t cx, int32_t cz);
+
+/** returns the height on the cached mesh surface at world (x, z), or nullopt when the chunk is not cached */
+std::optional<float> sample(float x, float z);
+
+/** returns the number of chunks the budget holds with the active encoding */
+int32_t get_capacity();
+
+/** frees the cache */
+void cleanup();
+
+} // namespace HeightCache
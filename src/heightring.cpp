@@ -0,0 +1,367 @@
+#include "heightring.hpp"
+#include "fog.hpp"
+#include "jobs.hpp"
+#include "rlgl.h"
+#include "terrain.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <memory>
+
+namespace {
+
+// 255^2 vertices fits 16-bit indices, and an odd vertex count puts both ends of every level on its parent's grid lines
+constexpr int32_t RING_SIZE = 255;
+constexpr size_t VERTEX_COUNT = static_cast<size_t>(RING_SIZE) * RING_SIZE;
+constexpr size_t INDEX_COUNT = static_cast<size_t>(RING_SIZE - 1) * (RING_SIZE - 1) * 6;
+constexpr int32_t MAX_LEVELS = 8;
+
+// lattice coordinate i always lives in slot i mod RING_SIZE, so scrolling never moves existing samples
+int32_t get_slot(int32_t i) { return ((i % RING_SIZE) + RING_SIZE) % RING_SIZE; }
+
+// lattice columns [x0, x1) over rows [z0, z1)
+struct Region {
+    int32_t x0;
+    int32_t x1;
+    int32_t z0;
+    int32_t z1;
+};
+
+// one ring of the clipmap: level l samples every 2^l world units
+struct RingLevel {
+    float spacing = 1.0f;
+    std::unique_ptr<float[]> vertices;
+    std::unique_ptr<float[]> normals;
+    std::unique_ptr<float[]> texcoords;
+    std::unique_ptr<unsigned char[]> colors;
+    std::unique_ptr<unsigned short[]> indices;
+    Mesh mesh = {};
+    Model model = {};
+    int32_t origin_x = 0; // lattice coordinate of the first logical column
+    int32_t origin_z = 0;
+    int32_t index_count = 0;
+    std::array<Region, 2> dirty = {}; // regenerated since the last upload: a scroll exposes columns and rows
+    int32_t dirty_count = 0;
+    bool valid = false;
+};
+
+struct HeightRingState {
+    std::array<RingLevel, MAX_LEVELS> levels;
+    int32_t level_count = 1;
+    Texture2D texture = {};
+    int64_t generated = 0;
+    int64_t uploaded = 0;
+    bool initialized = false;
+} internal_state;
+
+void ensure_initialized() {
+    auto &s = internal_state;
+    if (s.initialized) {
+        return;
+    }
+    s.initialized = true;
+    for (int32_t l = 0; l < s.level_count; ++l) {
+        RingLevel &level = s.levels[static_cast<size_t>(l)];
+        level.spacing = static_cast<float>(1 << l);
+        level.vertices = std::make_unique<float[]>(VERTEX_COUNT * 3);
+        level.normals = std::make_unique<float[]>(VERTEX_COUNT * 3);
+        level.texcoords = std::make_unique<float[]>(VERTEX_COUNT * 2);
+        level.colors = std::make_unique<unsigned char[]>(VERTEX_COUNT * 4);
+        level.indices = std::make_unique<unsigned short[]>(INDEX_COUNT);
+        level.mesh.vertexCount = static_cast<int>(VERTEX_COUNT);
+        level.mesh.triangleCount = static_cast<int>(INDEX_COUNT / 3);
+        level.mesh.vertices = level.vertices.get();
+        level.mesh.normals = level.normals.get();
+        level.mesh.texcoords = level.texcoords.get();
+        level.mesh.colors = level.colors.get();
+        level.mesh.indices = level.indices.get();
+    }
+    if (IsWindowReady()) {
+        Image img = GenImageColor(2, 2, WHITE);
+        s.texture = LoadTextureFromImage(img);
+        UnloadImage(img);
+    }
+}
+
+void generate_vertex(RingLevel &level, int32_t lx, int32_t lz) {
+    const auto i = static_cast<size_t>(get_slot(lz) * RING_SIZE + get_slot(lx));
+    const float wx = static_cast<float>(lx) * level.spacing;
+    const float wz = static_cast<float>(lz) * level.spacing;
+    const Terrain::SurfaceSample sample = Terrain::sample_surface(wx, wz, ((lx + lz) & 1) != 0);
+    level.vertices[i * 3] = wx;
+    level.vertices[i * 3 + 1] = sample.height;
+    level.vertices[i * 3 + 2] = wz;
+    level.normals[i * 3] = sample.normal.x;
+    level.normals[i * 3 + 1] = sample.normal.y;
+    level.normals[i * 3 + 2] = sample.normal.z;
+    level.colors[i * 4] = sample.color.r;
+    level.colors[i * 4 + 1] = sample.color.g;
+    level.colors[i * 4 + 2] = sample.color.b;
+    level.colors[i * 4 + 3] = sample.color.a;
+}
+
+// regenerates lattice columns [x0, x1) over rows [z0, z1), split by row across cores
+void generate_region(RingLevel &level, int32_t x0, int32_t x1, int32_t z0, int32_t z1) {
+    if (x0 >= x1 || z0 >= z1) {
+        return;
+    }
+    Jobs::parallel_for(z1 - z0, [&](int32_t row) {
+        for (int32_t lx = x0; lx < x1; ++lx) {
+            generate_vertex(level, lx, z0 + row);
+        }
+    });
+    internal_state.generated += static_cast<int64_t>(x1 - x0) * (z1 - z0);
+    assert(level.dirty_count < static_cast<int32_t>(level.dirty.size()));
+    level.dirty[static_cast<size_t>(level.dirty_count++)] = {x0, x1, z0, z1};
+}
+
+// triangulates the ring in logical order; the seam between the newest and oldest samples moves with the
+// origin, so the index buffer is rebuilt on every scroll (cheap next to generating even one row).
+// quads the finer level already covers are left out, keeping a one-quad overlap so no cracks open between levels
+void build_indices(RingLevel &level, const RingLevel *finer) {
+    int32_t hole_x0 = 0;
+    int32_t hole_z0 = 0;
+    int32_t hole_x1 = -1;
+    int32_t hole_z1 = -1;
+    if (finer != nullptr) {
+        // origins are even, so the finer ring spans whole quads of this one
+        hole_x0 = finer->origin_x / 2 - level.origin_x + 1;
+        hole_z0 = finer->origin_z / 2 - level.origin_z + 1;
+        hole_x1 = hole_x0 + (RING_SIZE - 1) / 2 - 2;
+        hole_z1 = hole_z0 + (RING_SIZE - 1) / 2 - 2;
+    }
+
+    size_t idx = 0;
+    for (int32_t z = 0; z < RING_SIZE - 1; ++z) {
+        const int32_t row = get_slot(level.origin_z + z) * RING_SIZE;
+        const int32_t next_row = get_slot(level.origin_z + z + 1) * RING_SIZE;
+        for (int32_t x = 0; x < RING_SIZE - 1; ++x) {
+            if (x >= hole_x0 && x < hole_x1 && z >= hole_z0 && z < hole_z1) {
+                continue;
+            }
+            const int32_t col = get_slot(level.origin_x + x);
+            const int32_t next_col = get_slot(level.origin_x + x + 1);
+            const auto tl = static_cast<unsigned short>(row + col);
+            const auto tr = static_cast<unsigned short>(row + next_col);
+            const auto bl = static_cast<unsigned short>(next_row + col);
+            const auto br = static_cast<unsigned short>(next_row + next_col);
+            level.indices[idx++] = tl;
+            level.indices[idx++] = bl;
+            level.indices[idx++] = tr;
+            level.indices[idx++] = tr;
+            level.indices[idx++] = bl;
+            level.indices[idx++] = br;
+        }
+    }
+    assert(idx <= INDEX_COUNT);
+    level.index_count = static_cast<int32_t>(idx);
+}
+
+// calls fn(first_slot, count) for the runs of slots that lattice coordinates [i0, i0 + count) occupy; at most two,
+// split where the range wraps
+template <typename Fn> void for_each_slot_run(int32_t i0, int32_t count, const Fn &fn) {
+    const int32_t first = get_slot(i0);
+    const int32_t head = std::min(count, RING_SIZE - first);
+    fn(first, head);
+    if (head < count) {
+        fn(0, count - head);
+    }
+}
+
+// sends slots [first, first + count) of every vertex attribute the ring regenerates
+void upload_slots(RingLevel &level, int32_t first, int32_t count) {
+    internal_state.uploaded += count;
+    if (level.model.meshCount == 0) {
+        return;
+    }
+    const auto offset = static_cast<size_t>(first);
+    const auto n = static_cast<size_t>(count);
+    UpdateMeshBuffer(level.mesh, 0, level.vertices.get() + offset * 3, static_cast<int>(n * 3 * sizeof(float)), static_cast<int>(offset * 3 * sizeof(float)));
+    UpdateMeshBuffer(level.mesh, 2, level.normals.get() + offset * 3, static_cast<int>(n * 3 * sizeof(float)), static_cast<int>(offset * 3 * sizeof(float)));
+    UpdateMeshBuffer(level.mesh, 3, level.colors.get() + offset * 4, static_cast<int>(n * 4), static_cast<int>(offset * 4));
+}
+
+// only the regenerated samples go to the gpu: exposed rows span whole slot rows, so they are one or two contiguous
+// ranges, while exposed columns are a short run in every row. the index buffer is rewritten in full, as it is rebuilt
+void upload(RingLevel &level) {
+    if (level.model.meshCount == 0 && IsWindowReady()) {
+        // the first upload sizes the index buffer for the full grid, later ones may draw fewer
+        UploadMesh(&level.mesh, true);
+        level.model = LoadModelFromMesh(level.mesh);
+        level.model.materials[0].maps[MATERIAL_MAP_DIFFUSE].texture = internal_state.texture;
+        // ring vertices are world-space, as the fog term expects
+        if (const Shader fog = Fog::get_shader(); fog.id != 0) {
+            level.model.materials[0].shader = fog;
+        }
+        internal_state.uploaded += static_cast<int64_t>(VERTEX_COUNT);
+    } else {
+        for (int32_t d = 0; d < level.dirty_count; ++d) {
+            const Region &r = level.dirty[static_cast<size_t>(d)];
+            if (r.x1 - r.x0 == RING_SIZE) {
+                for_each_slot_run(r.z0, r.z1 - r.z0, [&](int32_t row, int32_t rows) { upload_slots(level, row * RING_SIZE, rows * RING_SIZE); });
+                continue;
+            }
+            for (int32_t lz = r.z0; lz < r.z1; ++lz) {
+                const int32_t row = get_slot(lz) * RING_SIZE;
+                for_each_slot_run(r.x0, r.x1 - r.x0, [&](int32_t col, int32_t cols) { upload_slots(level, row + col, cols); });
+            }
+        }
+        if (level.model.meshCount > 0) {
+            UpdateMeshBuffer(level.mesh, 6, level.indices.get(), static_cast<int>(static_cast<size_t>(level.index_count) * sizeof(unsigned short)), 0);
+        }
+    }
+    level.dirty_count = 0;
+    if (level.model.meshCount > 0) {
+        level.model.meshes[0].triangleCount = level.index_count / 3;
+    }
+}
+
+// returns true when the level scrolled
+bool update_level(RingLevel &level, const Vector3 &center) {
+    // even origins keep every level aligned to the grid of the next coarser one
+    const auto snap = [&](float v) { return 2 * static_cast<int32_t>(std::floor(v / (2.0f * level.spacing))) - (RING_SIZE - 1) / 2 + 1; };
+    const int32_t origin_x = snap(center.x);
+    const int32_t origin_z = snap(center.z);
+    if (level.valid && origin_x == level.origin_x && origin_z == level.origin_z) {
+        return false;
+    }
+
+    const int32_t dx = origin_x - level.origin_x;
+    const int32_t dz = origin_z - level.origin_z;
+    if (!level.valid || std::abs(dx) >= RING_SIZE || std::abs(dz) >= RING_SIZE) {
+        // first frame or teleport: nothing survives
+        generate_region(level, origin_x, origin_x + RING_SIZE, origin_z, origin_z + RING_SIZE);
+    } else {
+        // newly exposed columns over the rows both windows share, then the newly exposed rows in full
+        const int32_t kept_z0 = std::max(origin_z, level.origin_z);
+        const int32_t kept_z1 = std::min(origin_z, level.origin_z) + RING_SIZE;
+        if (dx > 0) {
+            generate_region(level, level.origin_x + RING_SIZE, origin_x + RING_SIZE, kept_z0, kept_z1);
+        } else {
+            generate_region(level, origin_x, level.origin_x, kept_z0, kept_z1);
+        }
+        if (dz > 0) {
+            generate_region(level, origin_x, origin_x + RING_SIZE, level.origin_z + RING_SIZE, origin_z + RING_SIZE);
+        } else {
+            generate_region(level, origin_x, origin_x + RING_SIZE, origin_z, level.origin_z);
+        }
+    }
+    level.origin_x = origin_x;
+    level.origin_z = origin_z;
+    level.valid = true;
+    return true;
+}
+
+std::optional<float> sample_level(const RingLevel &level, float x, float z) {
+    if (!level.valid) {
+        return std::nullopt;
+    }
+    const float gx = x / level.spacing - static_cast<float>(level.origin_x);
+    const float gz = z / level.spacing - static_cast<float>(level.origin_z);
+    if (gx < 0.0f || gz < 0.0f || gx >= RING_SIZE - 1 || gz >= RING_SIZE - 1) {
+        return std::nullopt;
+    }
+
+    // same triangle split as the index buffer (along tr-bl)
+    const auto ix = static_cast<int32_t>(gx);
+    const auto iz = static_cast<int32_t>(gz);
+    const float fx = gx - static_cast<float>(ix);
+    const float fz = gz - static_cast<float>(iz);
+    const auto height = [&](int32_t x, int32_t z) { return level.vertices[static_cast<size_t>(get_slot(level.origin_z + z) * RING_SIZE + get_slot(level.origin_x + x)) * 3 + 1]; };
+    const float tr = height(ix + 1, iz);
+    const float bl = height(ix, iz + 1);
+    if (fx + fz <= 1.0f) {
+        const float tl = height(ix, iz);
+        return tl + fx * (tr - tl) + fz * (bl - tl);
+    }
+    const float br = height(ix + 1, iz + 1);
+    return br + (1.0f - fx) * (bl - br) + (1.0f - fz) * (tr - br);
+}
+
+} // namespace
+
+namespace HeightRing {
+
+void set_level_count(int32_t count) {
+    assert(count >= 1 && count <= MAX_LEVELS);
+    cleanup();
+    internal_state.level_count = count;
+}
+
+void update(const Vector3 &center) {
+    ensure_initialized();
+    auto &s = internal_state;
+    // a level's hole depends on the finer level, so a scroll anywhere re-triangulates the next level too
+    bool finer_scrolled = false;
+    for (int32_t l = 0; l < s.level_count; ++l) {
+        RingLevel &level = s.levels[static_cast<size_t>(l)];
+        const bool scrolled = update_level(level, center);
+        if (scrolled || finer_scrolled) {
+            build_indices(level, l > 0 ? &s.levels[static_cast<size_t>(l - 1)] : nullptr);
+            upload(level);
+        }
+        finer_scrolled = scrolled;
+    }
+}
+
+void draw() {
+    const auto &s = internal_state;
+    for (int32_t l = 0; l < s.level_count; ++l) {
+        const RingLevel &level = s.levels[static_cast<size_t>(l)];
+        if (level.model.meshCount > 0) {
+            // coarser levels sit slightly lower so the finer level wins where they overlap
+            DrawModel(level.model, {0.0f, -0.02f * static_cast<float>(l) * level.spacing, 0.0f}, 1.0f, WHITE);
+        }
+    }
+}
+
+std::optional<float> sample(float x, float z) {
+    const auto &s = internal_state;
+    for (int32_t l = 0; l < s.level_count; ++l) {
+        if (const std::optional<float> h = sample_level(s.levels[static_cast<size_t>(l)], x, z)) {
+            return h;
+        }
+    }
+    return std::nullopt;
+}
+
+int32_t get_resolution() { return RING_SIZE; }
+
+float get_extent() {
+    const auto &s = internal_state;
+    return static_cast<float>(RING_SIZE - 1) * static_cast<float>(1 << (s.level_count - 1));
+}
+
+int64_t get_generated_count() { return internal_state.generated; }
+
+int64_t get_uploaded_count() { return internal_state.uploaded; }
+
+void cleanup() {
+    auto &s = internal_state;
+    for (RingLevel &level : s.levels) {
+        if (level.model.meshCount > 0) {
+            // buffers are owned here, so only the gpu side goes through raylib
+            Mesh &mesh = level.model.meshes[0];
+            mesh.vertices = nullptr;
+            mesh.normals = nullptr;
+            mesh.texcoords = nullptr;
+            mesh.colors = nullptr;
+            mesh.indices = nullptr;
+            // the fog shader is shared, unloading the material must not free it
+            level.model.materials[0].shader = {.id = rlGetShaderIdDefault(), .locs = rlGetShaderLocsDefault()};
+            UnloadModel(level.model);
+        }
+        level = {};
+    }
+    if (s.texture.id != 0) {
+        UnloadTexture(s.texture);
+    }
+    const int32_t level_count = s.level_count;
+    s = {};
+    s.level_count = level_count;
+}
+
+} // namespace HeightRing
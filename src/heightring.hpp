@@ -0,0 +1,36 @@
+#pragma once
+
+#include "raylib.h"
+#include <cstdint>
+#include <optional>
+
+namespace HeightRing {
+
+/** sets how many nested rings to keep, each twice as coarse as the previous (1 is a single ring) */
+void set_level_count(int32_t count);
+
+/** recenters every ring on `center`, regenerating only the rows and columns that scrolled into view */
+void update(const Vector3 &center);
+
+/** draws all rings, finest first */
+void draw();
+
+/** returns the height on the finest ring covering world (x, z), or nullopt outside all rings */
+std::optional<float> sample(float x, float z);
+
+/** returns the number of vertices along a ring edge */
+int32_t get_resolution();
+
+/** returns the world-space edge length of the coarsest ring */
+float get_extent();
+
+/** returns how many vertices have been generated since the ring was created */
+int64_t get_generated_count();
+
+/** returns how many vertices have been written to the ring's gpu buffers (or would have been, without a window) */
+int64_t get_uploaded_count();
+
+/** frees the ring buffers */
+void cleanup();
+
+} // namespace HeightRing
@@ -0,0 +1,189 @@
+#include "horizon.hpp"
+#include "car.hpp"
+#include "fog.hpp"
+#include "jobs.hpp"
+#include "raymath.h"
+#include "rlgl.h"
+#include "terrain.hpp"
+
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <memory>
+
+namespace {
+
+constexpr int32_t COLUMNS = 512;       // azimuth resolution, one column per 0.7 degrees
+constexpr int32_t ROWS = 64;           // elevation resolution
+constexpr float ELEVATION_MIN = -0.08f; // radians below the eye plane
+constexpr float ELEVATION_MAX = 0.08f;  // radians above the eye plane
+constexpr float NEAR_DISTANCE = 120.0f; // the streamed terrain covers everything closer
+constexpr float FAR_DISTANCE = 4000.0f;
+constexpr int32_t MARCH_STEPS = 96;
+constexpr float RERENDER_DISTANCE = 40.0f;
+constexpr float CYLINDER_RADIUS = 900.0f; // inside the default far plane
+constexpr int32_t CYLINDER_SEGMENTS = 128;
+
+// one per player: in split-screen the cars may be any distance apart, and each sees its own silhouettes
+struct Panorama {
+    std::unique_ptr<Color[]> pixels;
+    Texture2D texture = {};
+    Vector3 rendered_at = {};
+    bool rendered = false;
+};
+
+struct HorizonState {
+    std::array<Panorama, Car::MAX_PLAYERS> panoramas;
+    Model cylinder = {};
+    int32_t selected = 0; // the panorama `draw` wraps around the camera
+    int64_t render_count = 0;
+    bool initialized = false;
+} internal_state;
+
+float get_row_elevation(int32_t row) { return ELEVATION_MAX - (static_cast<float>(row) + 0.5f) / ROWS * (ELEVATION_MAX - ELEVATION_MIN); }
+
+// an open cylinder around the origin whose top and bottom rims sit at the panorama's elevation limits
+Mesh gen_cylinder() {
+    Mesh mesh = {};
+    mesh.vertexCount = CYLINDER_SEGMENTS * 6;
+    mesh.triangleCount = CYLINDER_SEGMENTS * 2;
+    mesh.vertices = static_cast<float *>(MemAlloc(static_cast<unsigned int>(mesh.vertexCount * 3 * static_cast<int>(sizeof(float)))));
+    mesh.texcoords = static_cast<float *>(MemAlloc(static_cast<unsigned int>(mesh.vertexCount * 2 * static_cast<int>(sizeof(float)))));
+    const float top = CYLINDER_RADIUS * std::tan(ELEVATION_MAX);
+    const float bottom = CYLINDER_RADIUS * std::tan(ELEVATION_MIN);
+    int32_t v = 0;
+    const auto emit = [&](int32_t segment, bool upper) {
+        const float u = static_cast<float>(segment) / CYLINDER_SEGMENTS;
+        const float angle = u * 2.0f * PI;
+        mesh.vertices[v * 3] = std::cos(angle) * CYLINDER_RADIUS;
+        mesh.vertices[v * 3 + 1] = upper ? top : bottom;
+        mesh.vertices[v * 3 + 2] = std::sin(angle) * CYLINDER_RADIUS;
+        mesh.texcoords[v * 2] = u;
+        mesh.texcoords[v * 2 + 1] = upper ? 0.0f : 1.0f;
+        ++v;
+    };
+    for (int32_t i = 0; i < CYLINDER_SEGMENTS; ++i) {
+        emit(i, false);
+        emit(i, true);
+        emit(i + 1, true);
+        emit(i, false);
+        emit(i + 1, true);
+        emit(i + 1, false);
+    }
+    assert(v == mesh.vertexCount);
+    UploadMesh(&mesh, false);
+    return mesh;
+}
+
+void ensure_initialized() {
+    auto &s = internal_state;
+    if (s.initialized) {
+        return;
+    }
+    s.initialized = true;
+    for (Panorama &panorama : s.panoramas) {
+        panorama.pixels = std::make_unique<Color[]>(static_cast<size_t>(COLUMNS) * ROWS);
+        if (IsWindowReady()) {
+            const Image image = {.data = panorama.pixels.get(), .width = COLUMNS, .height = ROWS, .mipmaps = 1, .format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8};
+            panorama.texture = LoadTextureFromImage(image);
+            SetTextureWrap(panorama.texture, TEXTURE_WRAP_REPEAT);
+        }
+    }
+    if (IsWindowReady()) {
+        s.cylinder = LoadModelFromMesh(gen_cylinder());
+    }
+}
+
+// marches outward along one azimuth like a voxel-space renderer: every sample that rises above
+// everything nearer fills the rows between the old and the new silhouette with its hazed color
+void render_column(Color *pixels, const Vector3 &eye, int32_t column) {
+    const float azimuth = static_cast<float>(column) / COLUMNS * 2.0f * PI;
+    const float dir_x = std::cos(azimuth);
+    const float dir_z = std::sin(azimuth);
+
+    int32_t filled_from = ROWS; // rows [filled_from, ROWS) are covered
+    for (int32_t step = 0; step < MARCH_STEPS && filled_from > 0; ++step) {
+        // geometric spacing: far samples matter less per unit distance
+        const float t = static_cast<float>(step) / (MARCH_STEPS - 1);
+        const float distance = NEAR_DISTANCE * std::pow(FAR_DISTANCE / NEAR_DISTANCE, t);
+        const float height = Terrain::get_height(eye.x + dir_x * distance, eye.z + dir_z * distance);
+        const float elevation = std::atan2(height - eye.y, distance);
+        // the same fog the streamed terrain fades into, so the silhouette continues it without a seam
+        const Color color = ColorLerp(DARKGREEN, Fog::get_color(), Fog::get_factor(distance));
+        while (filled_from > 0 && get_row_elevation(filled_from - 1) <= elevation) {
+            pixels[static_cast<size_t>(--filled_from * COLUMNS + column)] = color;
+        }
+    }
+    // sky-tinted rather than black, so filtering does not darken the silhouette
+    const Color clear = {Fog::get_color().r, Fog::get_color().g, Fog::get_color().b, 0};
+    for (int32_t row = 0; row < filled_from; ++row) {
+        pixels[static_cast<size_t>(row * COLUMNS + column)] = clear;
+    }
+}
+
+} // namespace
+
+namespace Horizon {
+
+void update(const Vector3 &eye, int32_t view) {
+    assert(view >= 0 && view < Car::MAX_PLAYERS);
+    ensure_initialized();
+    auto &s = internal_state;
+    Panorama &panorama = s.panoramas[static_cast<size_t>(view)];
+    if (panorama.rendered && Vector3Distance(eye, panorama.rendered_at) < RERENDER_DISTANCE) {
+        return;
+    }
+    Jobs::parallel_for(COLUMNS, [&](int32_t column) { render_column(panorama.pixels.get(), eye, column); });
+    if (IsWindowReady()) {
+        UpdateTexture(panorama.texture, panorama.pixels.get());
+    }
+    panorama.rendered_at = eye;
+    panorama.rendered = true;
+    ++s.render_count;
+}
+
+void select(int32_t view) {
+    assert(view >= 0 && view < Car::MAX_PLAYERS);
+    internal_state.selected = view;
+}
+
+void draw(const Camera3D &camera) {
+    auto &s = internal_state;
+    if (s.cylinder.meshCount == 0) {
+        return;
+    }
+    s.cylinder.materials[0].maps[MATERIAL_MAP_DIFFUSE].texture = s.panoramas[static_cast<size_t>(s.selected)].texture;
+    // no depth writes, so whatever is drawn afterwards lands in front regardless of distance
+    rlDisableDepthMask();
+    rlDisableBackfaceCulling();
+    DrawModel(s.cylinder, camera.position, 1.0f, WHITE);
+    rlEnableBackfaceCulling();
+    rlEnableDepthMask();
+}
+
+int64_t get_render_count() { return internal_state.render_count; }
+
+Color get_pixel(int32_t column, int32_t row, int32_t view) {
+    assert(view >= 0 && view < Car::MAX_PLAYERS);
+    const Panorama &panorama = internal_state.panoramas[static_cast<size_t>(view)];
+    assert(panorama.pixels && column >= 0 && column < COLUMNS && row >= 0 && row < ROWS);
+    return panorama.pixels[static_cast<size_t>(row * COLUMNS + column)];
+}
+
+void cleanup() {
+    auto &s = internal_state;
+    if (s.cylinder.meshCount > 0) {
+        // the material only borrows a panorama texture, which is freed below
+        s.cylinder.materials[0].maps[MATERIAL_MAP_DIFFUSE].texture = {};
+        UnloadModel(s.cylinder);
+    }
+    for (const Panorama &panorama : s.panoramas) {
+        if (panorama.texture.id != 0) {
+            UnloadTexture(panorama.texture);
+        }
+    }
+    s = {};
+}
+
+} // namespace Horizon
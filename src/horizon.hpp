@@ -0,0 +1,26 @@
+#pragma once
+
+#include "raylib.h"
+#include <cstdint>
+
+namespace Horizon {
+
+/** re-renders player `view`'s panorama when its eye has moved far enough from where it was last rendered */
+void update(const Vector3 &eye, int32_t view = 0);
+
+/** sets whose panorama `draw` uses, until the next call */
+void select(int32_t view);
+
+/** draws the selected panorama as a cylinder around the camera, behind everything drawn after it */
+void draw(const Camera3D &camera);
+
+/** returns how many times any panorama has been rendered */
+int64_t get_render_count();
+
+/** returns the panorama pixel at (column, row), row 0 being the top; alpha is zero where sky shows through */
+Color get_pixel(int32_t column, int32_t row, int32_t view = 0);
+
+/** frees the panorama textures and cylinder */
+void cleanup();
+
+} // namespace Horizon
@@ -0,0 +1,112 @@
+#include "jobs.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct JobsState {
+    std::mutex mutex;
+    std::condition_variable_any wake;
+    std::condition_variable done;
+    const std::function<void(int32_t)> *task = nullptr;
+    int32_t count = 0;
+    std::atomic<int32_t> next = 0;
+    int32_t busy = 0;         // workers that have not finished the current generation
+    uint64_t generation = 0;  // bumped once per parallel_for
+    bool initialized = false;
+    std::vector<std::jthread> workers; // declared last: joined before the mutex and conditions are destroyed at exit
+} internal_state;
+
+void drain(const std::function<void(int32_t)> &task, int32_t count) {
+    for (int32_t i = internal_state.next.fetch_add(1); i < count; i = internal_state.next.fetch_add(1)) {
+        task(i);
+    }
+}
+
+void worker_loop(const std::stop_token &stop) {
+    auto &s = internal_state;
+    uint64_t seen = 0;
+    while (true) {
+        const std::function<void(int32_t)> *task = nullptr;
+        int32_t count = 0;
+        {
+            std::unique_lock lock(s.mutex);
+            if (!s.wake.wait(lock, stop, [&] { return s.generation != seen; })) {
+                return;
+            }
+            seen = s.generation;
+            task = s.task;
+            count = s.count;
+        }
+        drain(*task, count);
+        std::lock_guard lock(s.mutex);
+        if (--s.busy == 0) {
+            s.done.notify_one();
+        }
+    }
+}
+
+void ensure_initialized() {
+    if (internal_state.initialized) {
+        return;
+    }
+    internal_state.initialized = true;
+#ifndef __EMSCRIPTEN__
+    // the caller runs jobs too, so one core is left for it
+    const auto hardware = static_cast<int32_t>(std::thread::hardware_concurrency());
+    const int32_t worker_count = std::max(hardware - 1, 0);
+    internal_state.workers.reserve(static_cast<size_t>(worker_count));
+    for (int32_t i = 0; i < worker_count; ++i) {
+        internal_state.workers.emplace_back(worker_loop);
+    }
+#endif
+}
+
+} // namespace
+
+namespace Jobs {
+
+void parallel_for(int32_t count, const std::function<void(int32_t)> &fn) {
+    ensure_initialized();
+    auto &s = internal_state;
+    if (count <= 1 || s.workers.empty()) {
+        for (int32_t i = 0; i < count; ++i) {
+            fn(i);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard lock(s.mutex);
+        s.task = &fn;
+        s.count = count;
+        s.next = 0;
+        s.busy = static_cast<int32_t>(s.workers.size());
+        ++s.generation;
+    }
+    s.wake.notify_all();
+    drain(fn, count);
+
+    std::unique_lock lock(s.mutex);
+    s.done.wait(lock, [&] { return s.busy == 0; });
+    s.task = nullptr;
+}
+
+int32_t get_thread_count() {
+    ensure_initialized();
+    return static_cast<int32_t>(internal_state.workers.size()) + 1;
+}
+
+void cleanup() {
+    // jthread requests stop and joins, which also interrupts the condition wait
+    internal_state.workers.clear();
+    internal_state.initialized = false;
+}
+
+} // namespace Jobs
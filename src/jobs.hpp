@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+
+namespace Jobs {
+
+/** runs fn(i) for i in [0, count) across the worker threads and the caller, returns when all are done (serial on wasm, must not be nested) */
+void parallel_for(int32_t count, const std::function<void(int32_t)> &fn);
+
+/** returns the number of threads that execute a parallel_for, including the caller */
+int32_t get_thread_count();
+
+/** stops and joins the worker threads */
+void cleanup();
+
+} // namespace Jobs
@@ -1,19 +1,36 @@
 #include "landscape.hpp"
+#include "fog.hpp"
 #include "raymath.h"
+#include "renderqueue.hpp"
 #include "terrain.hpp"
 
 #include <algorithm>
+#include <array>
+#include <cassert>
 #include <cmath>
+#include <cstddef>
+#include <functional>
 #include <random>
+#include <sstream>
+#include <string>
 #include <vector>
 
 namespace {
 
 constexpr float SPAWN_RADIUS = 200.0f;
-constexpr float DESPAWN_RADIUS = 250.0f;
+constexpr float DESPAWN_MARGIN = 20.0f; // hysteresis, so elements at the rim do not flicker in and out
 constexpr float MIN_SPACING = 8.0f;
 constexpr int32_t ELEMENTS_PER_UPDATE = 5;
 
+// toroidal grid of MIN_SPACING cells: the spacing rule caps the occupants of a cell at four. the window is wider
+// than a spawn disc, so only foci far apart can wrap onto the same slots; spawning skips full cells for them
+constexpr float CELL_SIZE = MIN_SPACING;
+constexpr int32_t GRID_DIM = 64;
+constexpr int32_t CELL_CAPACITY = 4;
+constexpr float MAX_COLLISION_RADIUS = 1.5f; // largest bush
+static_assert(CELL_SIZE * GRID_DIM > 2.0f * (SPAWN_RADIUS + DESPAWN_MARGIN));
+static_assert((GRID_DIM & (GRID_DIM - 1)) == 0);
+
 enum class ElementType { TREE, BUSH };
 
 struct Element {
@@ -23,8 +40,23 @@ struct Element {
     Color color;
 };
 
+// what the broadphase keeps of an element: its footprint circle (trunk or bush)
+struct Occupant {
+    float x;
+    float z;
+    float radius;
+};
+
+struct Cell {
+    std::array<Occupant, CELL_CAPACITY> occupants;
+    int32_t count;
+};
+
 struct LandscapeState {
     std::vector<Element> elements;
+    std::array<Cell, GRID_DIM * GRID_DIM> grid = {};
+    int32_t collision_tests = 0;
+    int32_t drawn_count = 0;
     std::mt19937 rng{42};
     bool initialized = false;
 } internal_state;
@@ -34,13 +66,78 @@ void ensure_initialized() {
         return;
     }
     internal_state.initialized = true;
+    internal_state.elements.reserve(static_cast<size_t>(Landscape::MAX_ELEMENTS));
 }
 
+// nothing past the fog's cull distance can be seen, so nothing is spawned or kept there
+float get_spawn_radius() { return std::min(SPAWN_RADIUS, Fog::get_cull_distance()); }
+
 bool is_on_road(float x, float z) {
     float road_center = Terrain::get_road_center_x(z);
     return std::abs(x - road_center) < 8.0f;
 }
 
+int32_t cell_coord(float v) { return static_cast<int32_t>(std::floor(v / CELL_SIZE)); }
+
+size_t cell_index(int32_t cx, int32_t cz) { return static_cast<size_t>((cz & (GRID_DIM - 1)) * GRID_DIM + (cx & (GRID_DIM - 1))); }
+
+Cell &cell_at(int32_t cx, int32_t cz) { return internal_state.grid[cell_index(cx, cz)]; }
+
+float collision_radius(const Element &e) { return e.type == ElementType::TREE ? e.size * 0.08f : e.size * 0.5f; }
+
+bool is_cell_full(float x, float z) { return cell_at(cell_coord(x), cell_coord(z)).count == CELL_CAPACITY; }
+
+void grid_insert(const Element &e) {
+    Cell &cell = cell_at(cell_coord(e.position.x), cell_coord(e.position.z));
+    assert(cell.count < CELL_CAPACITY);
+    cell.occupants[static_cast<size_t>(cell.count++)] = {e.position.x, e.position.z, collision_radius(e)};
+}
+
+void grid_remove(const Element &e) {
+    Cell &cell = cell_at(cell_coord(e.position.x), cell_coord(e.position.z));
+    for (int32_t i = 0; i < cell.count; ++i) {
+        const Occupant &o = cell.occupants[static_cast<size_t>(i)];
+        if (o.x == e.position.x && o.z == e.position.z) {
+            cell.occupants[static_cast<size_t>(i)] = cell.occupants[static_cast<size_t>(--cell.count)];
+            return;
+        }
+    }
+    assert(false && "element missing from the grid");
+}
+
+// calls fn(occupant) for everything in the cells overlapping the square of half size `reach` around (x, z)
+template <typename Fn> void for_each_near(float x, float z, float reach, Fn &&fn) {
+    for (int32_t cz = cell_coord(z - reach); cz <= cell_coord(z + reach); ++cz) {
+        for (int32_t cx = cell_coord(x - reach); cx <= cell_coord(x + reach); ++cx) {
+            const Cell &cell = cell_at(cx, cz);
+            for (int32_t i = 0; i < cell.count; ++i) {
+                fn(cell.occupants[static_cast<size_t>(i)]);
+            }
+        }
+    }
+}
+
+// footprint box against footprint circle, in the box's frame: the push is along the closest face when the
+// circle's center is inside the box, otherwise away from the closest point on the box
+std::optional<Landscape::Contact> box_circle(Vector2 local, Vector2 half, float radius) {
+    const Vector2 closest = {std::clamp(local.x, -half.x, half.x), std::clamp(local.y, -half.y, half.y)};
+    const Vector2 diff = {local.x - closest.x, local.y - closest.y};
+    const float dist_sq = diff.x * diff.x + diff.y * diff.y;
+    if (dist_sq >= radius * radius) {
+        return std::nullopt;
+    }
+    if (dist_sq > 0.0f) {
+        const float dist = std::sqrt(dist_sq);
+        return Landscape::Contact{.normal = {-diff.x / dist, -diff.y / dist}, .depth = radius - dist};
+    }
+    const float gap_x = half.x - std::abs(local.x);
+    const float gap_z = half.y - std::abs(local.y);
+    if (gap_x < gap_z) {
+        return Landscape::Contact{.normal = {local.x > 0.0f ? -1.0f : 1.0f, 0.0f}, .depth = gap_x + radius};
+    }
+    return Landscape::Contact{.normal = {0.0f, local.y > 0.0f ? -1.0f : 1.0f}, .depth = gap_z + radius};
+}
+
 void draw_tree(const Element &e) {
     constexpr Color TRUNK_COLOR = {101, 67, 33, 255};
     float trunk_height = e.size * 0.4f;
@@ -48,10 +145,12 @@ void draw_tree(const Element &e) {
 
     Vector3 trunk_top = e.position;
     trunk_top.y += trunk_height;
-    DrawCylinderEx(e.position, trunk_top, e.size * 0.08f, e.size * 0.06f, 6, TRUNK_COLOR);
+    RenderQueue::submit_cylinder(e.position, trunk_top, e.size * 0.08f, e.size * 0.06f, 6, TRUNK_COLOR);
 
     // layered crown for fuller look
-    for (int layer = 0; layer < 3; ++layer) {
+    constexpr int32_t CROWN_LAYERS = 3;
+    static_assert(1 + CROWN_LAYERS <= Landscape::MAX_ITEMS_PER_ELEMENT);
+    for (int layer = 0; layer < CROWN_LAYERS; ++layer) {
         float layer_offset = static_cast<float>(layer) * crown_height * 0.25f;
         float layer_radius = e.size * (0.5f - static_cast<float>(layer) * 0.12f);
         Vector3 base = e.position;
@@ -59,16 +158,16 @@ void draw_tree(const Element &e) {
         Vector3 top = base;
         top.y += crown_height * 0.5f;
         Color layer_color = (layer == 1) ? GREEN : e.color;
-        DrawCylinderEx(base, top, layer_radius, 0.0f, 8, layer_color);
+        RenderQueue::submit_cylinder(base, top, layer_radius, 0.0f, 8, layer_color);
     }
 }
 
 void draw_bush(const Element &e) {
     // round bush made of overlapping spheres
-    DrawSphere(e.position, e.size * 0.5f, e.color);
+    RenderQueue::submit_sphere(e.position, e.size * 0.5f, e.color);
     Vector3 top = e.position;
     top.y += e.size * 0.3f;
-    DrawSphere(top, e.size * 0.4f, GREEN);
+    RenderQueue::submit_sphere(top, e.size * 0.4f, GREEN);
 }
 
 void draw_element(const Element &e) {
@@ -82,45 +181,34 @@ void draw_element(const Element &e) {
     }
 }
 
-} // namespace
-
-namespace Landscape {
-
-void update(const Vector3 &car_pos) {
-    ensure_initialized();
-
-    std::erase_if(internal_state.elements, [&](const Element &e) {
-        float dx = e.position.x - car_pos.x;
-        float dz = e.position.z - car_pos.z;
-        return std::sqrt(dx * dx + dz * dz) > DESPAWN_RADIUS;
-    });
-
+// a few spawn attempts in the disc around `center`; the spacing check makes overlapping discs share elements
+void spawn_around(const Vector3 &center, float spawn_radius) {
     std::uniform_real_distribution<float> angle_dist(0.0f, 2.0f * 3.14159265f);
-    std::uniform_real_distribution<float> radius_dist(15.0f, SPAWN_RADIUS);
+    std::uniform_real_distribution<float> radius_dist(15.0f, spawn_radius);
     std::uniform_real_distribution<float> type_dist(0.0f, 1.0f);
     std::uniform_real_distribution<float> size_var(0.8f, 1.2f);
 
     const Color tree_colors[] = {DARKGREEN, {0, 100, 0, 255}, {34, 139, 34, 255}};
     const Color bush_colors[] = {GREEN, DARKGREEN, {107, 142, 35, 255}};
 
-    for (int i = 0; i < ELEMENTS_PER_UPDATE; ++i) {
+    for (int i = 0; i < ELEMENTS_PER_UPDATE && internal_state.elements.size() < static_cast<size_t>(Landscape::MAX_ELEMENTS); ++i) {
         float angle = angle_dist(internal_state.rng);
         float radius = radius_dist(internal_state.rng);
-        float x = car_pos.x + std::cos(angle) * radius;
-        float z = car_pos.z + std::sin(angle) * radius;
+        float x = center.x + std::cos(angle) * radius;
+        float z = center.z + std::sin(angle) * radius;
 
         if (is_on_road(x, z)) {
             continue;
         }
 
-        float min_dist = MIN_SPACING;
-        bool too_close = std::any_of(internal_state.elements.begin(), internal_state.elements.end(), [x, z, min_dist](const Element &e) {
-            float dx = e.position.x - x;
-            float dz = e.position.z - z;
-            return std::sqrt(dx * dx + dz * dz) < min_dist;
+        bool too_close = false;
+        for_each_near(x, z, MIN_SPACING, [&](const Occupant &o) {
+            float dx = o.x - x;
+            float dz = o.z - z;
+            too_close = too_close || std::sqrt(dx * dx + dz * dz) < MIN_SPACING;
         });
 
-        if (too_close) {
+        if (too_close || is_cell_full(x, z)) {
             continue;
         }
 
@@ -141,16 +229,147 @@ void update(const Vector3 &car_pos) {
         }
 
         internal_state.elements.push_back(elem);
+        grid_insert(elem);
     }
 }
 
-void draw() {
+} // namespace
+
+namespace Landscape {
+
+void update(const Vector3 &car_pos) {
+    const Terrain::Focus focus = {.position = car_pos, .priority = 0};
+    Landscape::update(std::span(&focus, 1));
+}
+
+void update(std::span<const Terrain::Focus> foci) {
     ensure_initialized();
+    const float spawn_radius = get_spawn_radius();
+
+    // elements stay while any focus is close enough to see them
+    std::erase_if(internal_state.elements, [&](const Element &e) {
+        const bool seen = std::ranges::any_of(foci, [&](const Terrain::Focus &focus) {
+            float dx = e.position.x - focus.position.x;
+            float dz = e.position.z - focus.position.z;
+            return std::sqrt(dx * dx + dz * dz) <= spawn_radius + DESPAWN_MARGIN;
+        });
+        if (seen) {
+            return false;
+        }
+        grid_remove(e);
+        return true;
+    });
+
+    std::array<const Terrain::Focus *, 8> order;
+    assert(foci.size() <= order.size());
+    const auto ranked = std::span(order.data(), foci.size());
+    std::ranges::transform(foci, ranked.begin(), [](const Terrain::Focus &focus) { return &focus; });
+    std::ranges::stable_sort(ranked, std::greater{}, &Terrain::Focus::priority);
+    for (const Terrain::Focus *focus : ranked) {
+        spawn_around(focus->position, spawn_radius);
+    }
+}
+
+void draw(std::span<const Frustum::Volume> views) {
+    ensure_initialized();
+    int32_t drawn = 0;
     for (const auto &e : internal_state.elements) {
-        draw_element(e);
+        // trees and bushes are about as wide as they are tall, so a sphere of their size around their middle bounds them
+        const Vector3 middle = {e.position.x, e.position.y + e.size * 0.5f, e.position.z};
+        if (std::ranges::any_of(views, [&](const Frustum::Volume &view) { return Frustum::intersects_sphere(view, middle, e.size); })) {
+            draw_element(e);
+            ++drawn;
+        }
+    }
+    internal_state.drawn_count = drawn;
+}
+
+std::optional<Contact> collide(Vector2 center, Vector2 half_extents, float heading) {
+    ensure_initialized();
+    const float s = std::sin(heading);
+    const float c = std::cos(heading);
+    const float reach = std::sqrt(half_extents.x * half_extents.x + half_extents.y * half_extents.y) + MAX_COLLISION_RADIUS;
+    std::optional<Contact> deepest;
+    int32_t tests = 0;
+    for_each_near(center.x, center.y, reach, [&](const Occupant &o) {
+        ++tests;
+        // into the footprint's frame: x along its right axis (c, -s), z along its forward axis (s, c)
+        const float dx = o.x - center.x;
+        const float dz = o.z - center.y;
+        const auto contact = box_circle({dx * c - dz * s, dx * s + dz * c}, half_extents, o.radius);
+        if (contact && (!deepest || contact->depth > deepest->depth)) {
+            const Vector2 n = contact->normal;
+            deepest = Contact{.normal = {n.x * c + n.y * s, -n.x * s + n.y * c}, .depth = contact->depth};
+        }
+    });
+    internal_state.collision_tests = tests;
+    return deepest;
+}
+
+int32_t get_count() { return static_cast<int32_t>(internal_state.elements.size()); }
+
+Vector3 get_position(int32_t index) {
+    assert(index >= 0 && index < get_count());
+    return internal_state.elements[static_cast<size_t>(index)].position;
+}
+
+int32_t get_collision_tests() { return internal_state.collision_tests; }
+
+int32_t get_drawn_count() { return internal_state.drawn_count; }
+
+void save(Snapshot::Writer &writer) {
+    const auto &elements = internal_state.elements;
+    writer.write(static_cast<uint32_t>(sizeof(Element)));
+    writer.write(static_cast<uint32_t>(elements.size()));
+    writer.write_bytes(std::as_bytes(std::span(elements)));
+    // the standard only exposes the engine state as text, which round-trips it exactly
+    std::ostringstream rng;
+    rng << internal_state.rng;
+    const std::string text = rng.str();
+    writer.write(static_cast<uint32_t>(text.size()));
+    writer.write_bytes(std::as_bytes(std::span(text)));
+}
+
+Snapshot::Restore load(Snapshot::Reader &reader) {
+    uint32_t element_size = 0;
+    uint32_t count = 0;
+    if (!reader.read(element_size) || element_size != sizeof(Element) || !reader.read(count) || count > static_cast<uint32_t>(MAX_ELEMENTS)) {
+        return {};
+    }
+    std::vector<Element> elements(count);
+    uint32_t text_size = 0;
+    if (!reader.read_bytes(std::as_writable_bytes(std::span(elements))) || !reader.read(text_size)) {
+        return {};
+    }
+    std::string text(std::min<size_t>(text_size, reader.get_remaining()), '\0');
+    std::mt19937 rng;
+    if (text.size() != text_size || !reader.read_bytes(std::as_writable_bytes(std::span(text))) || !(std::istringstream(text) >> rng)) {
+        return {};
+    }
+    // the grid holds a bounded number of elements per cell, so anything a live session could not have spawned is rejected
+    std::array<int32_t, GRID_DIM * GRID_DIM> occupancy = {};
+    for (const Element &e : elements) {
+        if ((e.type != ElementType::TREE && e.type != ElementType::BUSH) || !std::isfinite(e.position.x) || !std::isfinite(e.position.z) || ++occupancy[cell_index(cell_coord(e.position.x), cell_coord(e.position.z))] > CELL_CAPACITY) {
+            return {};
+        }
     }
+
+    return [elements = std::move(elements), rng] {
+        ensure_initialized();
+        cleanup();
+        for (const Element &e : elements) {
+            internal_state.elements.push_back(e);
+            grid_insert(e);
+        }
+        internal_state.rng = rng;
+    };
 }
 
-void cleanup() { internal_state.elements.clear(); }
+void cleanup() {
+    internal_state.elements.clear();
+    for (Cell &cell : internal_state.grid) {
+        cell.count = 0;
+    }
+}
 
 } // namespace Landscape
@@ -1,14 +1,60 @@
 #pragma once
 
+#include "frustum.hpp"
 #include "raylib.h"
+#include "snapshot.hpp"
+#include "terrain.hpp"
+#include <cstdint>
+#include <optional>
+#include <span>
 
 namespace Landscape {
 
+constexpr int32_t MAX_ELEMENTS = 4096;        // memory cap across all foci
+constexpr int32_t MAX_ITEMS_PER_ELEMENT = 4; // render queue items one element submits (a tree: trunk and three crown layers)
+
+/** an overlap between a footprint and a landscape element */
+struct Contact {
+    Vector2 normal; // xz direction that pushes the footprint out of the element
+    float depth;    // how far the footprint has to move along `normal`
+};
+
 /** updates landscape elements based on car position (generates/unloads trees) */
 void update(const Vector3 &car_pos);
 
-/** draws landscape elements (trees) */
-void draw();
+/** keeps elements around every focus; overlapping discs share their elements, and spawning serves the foci in
+    priority order until the element cap is reached */
+void update(std::span<const Terrain::Focus> foci);
+
+/** queues the landscape elements inside any of `views` for drawing */
+void draw(std::span<const Frustum::Volume> views);
+
+/** tests an oriented footprint on the ground (xz `center`, `half_extents` along its right and forward axes,
+    `heading` like the car's) against the tree trunks and bushes in the grid cells it touches; returns the deepest contact */
+std::optional<Contact> collide(Vector2 center, Vector2 half_extents, float heading);
+
+/** appends the loaded elements and the spawn rng to `writer` */
+void save(Snapshot::Writer &writer);
+
+/** reads the elements and spawn rng `save` wrote and returns what puts them in place of the loaded ones, so later
+    spawns continue the saved sequence; empty if the data is malformed */
+Snapshot::Restore load(Snapshot::Reader &reader);
+
+//
+// getters
+//
+
+/** returns the number of loaded elements */
+int32_t get_count();
+
+/** returns the ground position of element `index` */
+Vector3 get_position(int32_t index);
+
+/** returns the number of elements the last collide() call tested */
+int32_t get_collision_tests();
+
+/** returns the number of elements the last draw() queued */
+int32_t get_drawn_count();
 
 /** cleans up landscape resources */
 void cleanup();
@@ -1,14 +1,36 @@
+#include "atlas.hpp"
 #include "camera.hpp"
 #include "car.hpp"
+#include "fog.hpp"
+#include "frustum.hpp"
+#include "heightcache.hpp"
+#include "heightring.hpp"
+#include "horizon.hpp"
+#include "jobs.hpp"
 #include "landscape.hpp"
+#include "minimap.hpp"
+#include "mirror.hpp"
 #include "raylib.h"
-#include "sky.hpp"
+#include "recorder.hpp"
+#include "renderqueue.hpp"
+#include "resolution.hpp"
+#include "rlgl.h"
+#include "scene.hpp"
+#include "snapshot.hpp"
+#include "splitscreen.hpp"
 #include "terrain.hpp"
+#include "traffic.hpp"
 
 #include <algorithm>
+#include <array>
+#include <chrono>
+#include <cinttypes>
 #include <cstdint>
 #include <cstdio>
 #include <cstdlib>
+#include <span>
+#include <string>
+#include <string_view>
 
 void draw_hud() {
     char buf[64];
@@ -17,34 +39,206 @@ void draw_hud() {
     Vector3 pos = Car::get_position();
     std::snprintf(buf, sizeof(buf), "X: %.2f Y: %.2f Z: %.2f", pos.x, pos.y, pos.z);
     DrawText(buf, 10, 60, 20, LIGHTGRAY);
+    const Terrain::DrawStats stats = Terrain::get_draw_stats();
+    std::snprintf(buf, sizeof(buf), "TERRAIN: %d draws, %d binds", stats.draw_calls, stats.shader_binds + stats.texture_binds);
+    DrawText(buf, 10, 80, 20, LIGHTGRAY);
+    const RenderQueue::Stats queue = RenderQueue::get_stats();
+    std::snprintf(buf, sizeof(buf), "QUEUE: %d items (%d dropped), %d -> %d state changes", queue.items, queue.dropped, queue.submitted_state_changes, queue.sorted_state_changes);
+    DrawText(buf, 10, 100, 20, LIGHTGRAY);
+    std::snprintf(buf, sizeof(buf), "RES: %d%%", static_cast<int32_t>(Resolution::get_scale() * 100.0f));
+    DrawText(buf, 10, 120, 20, LIGHTGRAY);
+    if (Mirror::is_enabled()) {
+        std::snprintf(buf, sizeof(buf), "MIRROR: %.2f ms every %d frames", Mirror::get_cost_ms(), Mirror::get_interval());
+        DrawText(buf, 10, 140, 20, LIGHTGRAY);
+    }
+    if (Traffic::get_count() > 0) {
+        std::snprintf(buf, sizeof(buf), "TRAFFIC: %d cars, %.3f us/car", Traffic::get_count(), Traffic::get_cost_us());
+        DrawText(buf, 10, 180, 20, LIGHTGRAY);
+    }
+    if (SplitScreen::is_enabled()) {
+        std::snprintf(buf, sizeof(buf), "SPLIT: P2 %.2f speed, %.1f ms frame", Car::get_speed(1), GetFrameTime() * 1000.0f);
+        DrawText(buf, 10, 200, 20, LIGHTGRAY);
+    }
+    if (Recorder::is_recording()) {
+        std::snprintf(buf, sizeof(buf), "REC: %" PRId64 " frames, %" PRId64 " dropped, %.2f ms capture, %.1f ms frame", Recorder::get_written_count(), Recorder::get_dropped_count(), Recorder::get_capture_ms(), GetFrameTime() * 1000.0f);
+        DrawText(buf, 10, 160, 20, RED);
+    }
 }
 
-int32_t main() {
+int32_t main(int32_t argc, char *argv[]) {
+    const auto launch = std::chrono::steady_clock::now();
+    const auto ms_since_launch = [&] { return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - launch).count(); };
+
     InitWindow(800, 450, "silly roads");
     SetTargetFPS(300);
 
-    while (!WindowShouldClose()) {
-        float dt = std::min(GetFrameTime(), 0.1f);
-        const Camera3D &camera = Cam::update(dt);
+    int32_t traffic = 0;
+    std::string snapshot;
+    for (int32_t i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        // chunks inside a baked region stream from the mapped file, the rest stays procedural
+        if (arg.starts_with("--atlas=") && !Atlas::open(arg.substr(8))) {
+            TraceLog(LOG_WARNING, "ATLAS: could not map %s, falling back to procedural terrain", argv[i] + 8);
+        }
+        if (arg == "--terrain=ring") {
+            Terrain::set_representation(Terrain::Representation::RING);
+        } else if (arg == "--terrain=clipmap") {
+            Terrain::set_representation(Terrain::Representation::CLIPMAP);
+            // the far plane has to reach the coarsest ring; a larger near plane keeps depth precision at that range
+            rlSetClipPlanes(0.1, HeightRing::get_extent());
+        }
+        // height queries on revisited terrain decode a compact cached heightfield instead of evaluating noise
+        if (arg == "--height-cache=f32") {
+            HeightCache::configure(HeightCache::Encoding::FLOAT32);
+        } else if (arg == "--height-cache=q16") {
+            HeightCache::configure(HeightCache::Encoding::QUANTIZED16);
+        } else if (arg == "--height-cache=delta8") {
+            HeightCache::configure(HeightCache::Encoding::DELTA8);
+        }
+        // rear-view mirror at half its on-screen resolution, refreshed every other frame unless told otherwise
+        if (arg == "--mirror") {
+            Mirror::configure(0.5f, 2);
+        } else if (arg.starts_with("--mirror=")) {
+            Mirror::configure(0.5f, std::max(1, std::atoi(argv[i] + 9)));
+        }
+        // npc cars on the road, simulated around the player
+        if (arg.starts_with("--traffic=")) {
+            traffic = std::clamp(std::atoi(argv[i] + 10), 0, 4096);
+        }
+        if (arg.starts_with("--record=")) {
+            Recorder::start(arg.substr(9));
+        }
+        // resumes the session saved at this path (F5 and quitting save it again)
+        if (arg.starts_with("--snapshot=")) {
+            snapshot = arg.substr(11);
+        }
+        // two players side by side, sharing every world cache
+        if (arg == "--split") {
+            Car::set_player_count(2);
+            SplitScreen::enable();
+        }
+    }
+    // the mirror and the recorder work on the single full-window view
+    if (SplitScreen::is_enabled() && (Mirror::is_enabled() || Recorder::is_recording())) {
+        TraceLog(LOG_WARNING, "SPLIT: mirror and recording are not available in split-screen");
+        Mirror::cleanup();
+        Recorder::stop();
+    }
 
-        Landscape::update(Car::get_position());
+    // the fog closes in where the resident terrain ends, hiding chunks streaming in at the rim
+    Fog::configure(Terrain::get_view_distance());
+    RenderQueue::set_shader(RenderQueue::State::BATCH, Fog::get_shader());
 
-        BeginDrawing();
-        ClearBackground(SKYBLUE);
-        BeginMode3D(camera);
+    // minimal loading screen while the initial chunk window is generated across cores
+    BeginDrawing();
+    ClearBackground(SKYBLUE);
+    DrawText("loading...", 10, 10, 20, WHITE);
+    EndDrawing();
+    const double first_frame_ms = ms_since_launch();
+    // restored chunks stay resident, so only what the snapshot lacks is generated below
+    if (!snapshot.empty() && !Snapshot::load(snapshot)) {
+        TraceLog(LOG_INFO, "SNAPSHOT: nothing to resume from %s, starting fresh", snapshot.c_str());
+    }
+    Terrain::update(Car::get_position());
+    Traffic::spawn(traffic, Car::get_position());
+
+    bool interactive = false;
+    while (!WindowShouldClose()) {
+        float dt = std::min(GetFrameTime(), 0.1f);
+        const int32_t players = Car::get_player_count();
+        std::array<Camera3D, Car::MAX_PLAYERS> cameras = {};
+        // the world streams around every viewpoint that needs it. past the memory cap the players keep their
+        // windows first and the mirror gives way. npc cars need no focus of their own: the visible ones are inside a
+        // player's window, and their wheels sample the height field, not resident chunks
+        std::array<Terrain::Focus, Car::MAX_PLAYERS + 1> focus_storage = {};
+        size_t focus_count = 0;
+        for (int32_t player = 0; player < players; ++player) {
+            cameras[static_cast<size_t>(player)] = Cam::update(dt, player);
+            focus_storage[focus_count++] = {.position = Car::get_position(player), .priority = 2};
+        }
+        if (Mirror::is_enabled()) {
+            focus_storage[focus_count++] = {.position = Mirror::get_position(), .priority = 1};
+        }
+        const auto foci = std::span(focus_storage.data(), focus_count);
+        const Camera3D &camera = cameras[0];
 
-        Sky::draw(camera);
-        Terrain::draw();
-        Landscape::draw();
+        Terrain::update(foci);
+        Landscape::update(foci);
+        Minimap::update(Car::get_position());
+        // npc cars wrap around the nearest player, and every player sees the horizon from their own eye
+        static_assert(Car::MAX_PLAYERS <= Traffic::MAX_FOCI);
+        std::array<Vector3, Car::MAX_PLAYERS> player_positions = {};
+        for (int32_t player = 0; player < players; ++player) {
+            player_positions[static_cast<size_t>(player)] = Car::get_position(player);
+            Horizon::update(cameras[static_cast<size_t>(player)].position, player);
+        }
+        Traffic::update(dt, std::span(player_positions.data(), static_cast<size_t>(players)));
         Car::update(dt);
 
-        EndMode3D();
+        BeginDrawing();
+        if (SplitScreen::is_enabled()) {
+            // each half culls and draws on its own; streaming, caches and meshes above were updated once for both
+            for (int32_t player = 0; player < players; ++player) {
+                const Camera3D &view_camera = cameras[static_cast<size_t>(player)];
+                const std::array views = {Frustum::from_camera(view_camera, SplitScreen::get_aspect())};
+                SplitScreen::begin_view(player);
+                Scene::draw(view_camera, views, player);
+                SplitScreen::end_view();
+            }
+            SplitScreen::draw();
+        } else {
+            // the scene is fill-bound and scales with the frame budget, the hud stays at native resolution
+            const float aspect = static_cast<float>(GetRenderWidth()) / static_cast<float>(std::max(1, GetRenderHeight()));
+            std::array views = {Frustum::from_camera(camera, aspect), Frustum::Volume{}};
+            const size_t view_count = Mirror::is_enabled() ? 2 : 1;
+            if (Mirror::is_enabled()) {
+                views[1] = Mirror::get_view();
+            }
+            Resolution::begin();
+            Scene::draw(camera, std::span(views.data(), view_count));
+            Resolution::end();
+            // F9 toggles recording; frames are captured before the mirror and hud are composited
+            if (IsKeyPressed(KEY_F9) && Recorder::is_recording()) {
+                Recorder::stop();
+            } else if (IsKeyPressed(KEY_F9)) {
+                Recorder::start("recording");
+            }
+            Recorder::capture();
+            Mirror::update();
+            Mirror::draw();
+        }
+        Minimap::draw();
         draw_hud();
         EndDrawing();
+        if (IsKeyPressed(KEY_F5) && !snapshot.empty() && !Snapshot::save(snapshot)) {
+            TraceLog(LOG_WARNING, "SNAPSHOT: could not write %s", snapshot.c_str());
+        }
+        if (!SplitScreen::is_enabled()) {
+            Resolution::update(GetFrameTime());
+        }
+
+        if (!interactive) {
+            interactive = true;
+            TraceLog(LOG_INFO, "STARTUP: first frame %.1f ms, interactive %.1f ms (%d threads)", first_frame_ms, ms_since_launch(), Jobs::get_thread_count());
+        }
     }
 
+    if (!snapshot.empty() && !Snapshot::save(snapshot)) {
+        TraceLog(LOG_WARNING, "SNAPSHOT: could not write %s", snapshot.c_str());
+    }
     Landscape::cleanup();
+    Traffic::cleanup();
+    Recorder::cleanup();
+    Resolution::cleanup();
+    Mirror::cleanup();
+    SplitScreen::cleanup();
+    Minimap::cleanup();
+    Horizon::cleanup();
     Terrain::cleanup();
+    Fog::cleanup();
+    Atlas::cleanup();
+    HeightCache::cleanup();
+    Jobs::cleanup();
     CloseWindow();
     return EXIT_SUCCESS;
 }
@@ -0,0 +1,176 @@
+#include "minimap.hpp"
+#include "car.hpp"
+#include "raymath.h"
+#include "terrain.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+
+namespace {
+
+constexpr int32_t MAP_TILES = 8;       // per axis; wider than the resident window, so every resident chunk has its own tile
+constexpr int32_t TILE_PIXELS = 16;    // per chunk edge; keeps the texture a power of two for repeat wrapping on webgl
+constexpr int32_t MAP_PIXELS = MAP_TILES * TILE_PIXELS;
+constexpr int32_t VIEW_PIXELS = 64;    // texels shown around the car
+constexpr float SCREEN_SIZE = 192.0f;  // on-screen edge length
+constexpr float MARGIN = 10.0f;
+constexpr float ROAD_HALF_WIDTH = 4.0f; // the asphalt, without its blended shoulders
+constexpr Color ROAD_COLOR = {30, 30, 30, 255};
+constexpr Color LOW_COLOR = {40, 110, 40, 255};
+constexpr Color HIGH_COLOR = {150, 170, 90, 255};
+constexpr std::array<Color, 2> MARKER_COLORS = {RED, SKYBLUE}; // per player
+constexpr Vector3 LIGHT_DIRECTION = {-0.5773f, 0.5773f, 0.5773f}; // from the upper left of the map, as hillshades are conventionally lit
+
+struct Tile {
+    int32_t cx;
+    int32_t cz;
+    bool valid;
+};
+
+struct MinimapState {
+    std::array<Color, static_cast<size_t>(MAP_PIXELS) * MAP_PIXELS> pixels = {};
+    std::array<Tile, static_cast<size_t>(MAP_TILES) * MAP_TILES> tiles = {};
+    Texture2D texture = {};
+    int64_t tile_updates = 0;
+    bool initialized = false;
+} internal_state;
+
+void ensure_initialized() {
+    auto &s = internal_state;
+    if (s.initialized) {
+        return;
+    }
+    s.initialized = true;
+    if (IsWindowReady()) {
+        const Image image = {.data = s.pixels.data(), .width = MAP_PIXELS, .height = MAP_PIXELS, .mipmaps = 1, .format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8};
+        s.texture = LoadTextureFromImage(image);
+        SetTextureWrap(s.texture, TEXTURE_WRAP_REPEAT);
+    }
+}
+
+int32_t wrap(int32_t value, int32_t size) { return ((value % size) + size) % size; }
+
+float get_units_per_pixel() { return Terrain::get_chunk_size() / TILE_PIXELS; }
+
+// nearest mesh vertex per texel: the heightfield is already resident, so no noise is evaluated here
+void rasterize(const Mesh &mesh, int32_t cx, int32_t cz, Color *tile) {
+    const int32_t resolution = Terrain::get_chunk_resolution();
+    const float chunk_size = Terrain::get_chunk_size();
+    const float units_per_pixel = get_units_per_pixel();
+    for (int32_t py = 0; py < TILE_PIXELS; ++py) {
+        const float local_z = (static_cast<float>(py) + 0.5f) * units_per_pixel;
+        const float world_z = static_cast<float>(cz) * chunk_size + local_z;
+        const float road_x = Terrain::get_road_center_x(world_z);
+        const auto vz = static_cast<int32_t>(std::lround(local_z / chunk_size * static_cast<float>(resolution - 1)));
+        for (int32_t px = 0; px < TILE_PIXELS; ++px) {
+            const float local_x = (static_cast<float>(px) + 0.5f) * units_per_pixel;
+            Color &out = tile[py * TILE_PIXELS + px];
+            if (std::abs(static_cast<float>(cx) * chunk_size + local_x - road_x) < ROAD_HALF_WIDTH) {
+                out = ROAD_COLOR;
+                continue;
+            }
+            const auto vx = static_cast<int32_t>(std::lround(local_x / chunk_size * static_cast<float>(resolution - 1)));
+            const auto v = static_cast<size_t>(vz * resolution + vx);
+            const Vector3 normal = {mesh.normals[v * 3], mesh.normals[v * 3 + 1], mesh.normals[v * 3 + 2]};
+            const float height = mesh.vertices[v * 3 + 1];
+            const float light = 0.55f + 0.6f * std::max(Vector3DotProduct(normal, LIGHT_DIRECTION), 0.0f);
+            const Color base = ColorLerp(LOW_COLOR, HIGH_COLOR, Clamp(height / 14.0f + 0.5f, 0.0f, 1.0f));
+            out = ColorBrightness(base, Clamp(light - 1.0f, -1.0f, 1.0f));
+        }
+    }
+}
+
+} // namespace
+
+namespace Minimap {
+
+void update(const Vector3 &car_pos) {
+    ensure_initialized();
+    auto &s = internal_state;
+    const float chunk_size = Terrain::get_chunk_size();
+    const auto car_cx = static_cast<int32_t>(std::floor(car_pos.x / chunk_size));
+    const auto car_cz = static_cast<int32_t>(std::floor(car_pos.z / chunk_size));
+    const int32_t radius = MAP_TILES / 2 - 1;
+    std::array<Color, static_cast<size_t>(TILE_PIXELS) * TILE_PIXELS> staging;
+    for (int32_t cz = car_cz - radius; cz <= car_cz + radius; ++cz) {
+        for (int32_t cx = car_cx - radius; cx <= car_cx + radius; ++cx) {
+            const int32_t tx = wrap(cx, MAP_TILES);
+            const int32_t tz = wrap(cz, MAP_TILES);
+            Tile &tile = s.tiles[static_cast<size_t>(tz * MAP_TILES + tx)];
+            if (tile.valid && tile.cx == cx && tile.cz == cz) {
+                continue;
+            }
+            const Mesh *mesh = Terrain::find_chunk_mesh(cx, cz);
+            if (mesh == nullptr) {
+                continue;
+            }
+            rasterize(*mesh, cx, cz, staging.data());
+            for (int32_t row = 0; row < TILE_PIXELS; ++row) {
+                Color *dst = &s.pixels[static_cast<size_t>((tz * TILE_PIXELS + row) * MAP_PIXELS + tx * TILE_PIXELS)];
+                std::copy_n(&staging[static_cast<size_t>(row * TILE_PIXELS)], TILE_PIXELS, dst);
+            }
+            // only the changed tile crosses to the gpu
+            if (s.texture.id != 0) {
+                UpdateTextureRec(s.texture, {static_cast<float>(tx * TILE_PIXELS), static_cast<float>(tz * TILE_PIXELS), TILE_PIXELS, TILE_PIXELS}, staging.data());
+            }
+            tile = {.cx = cx, .cz = cz, .valid = true};
+            ++s.tile_updates;
+        }
+    }
+}
+
+void draw() {
+    const auto &s = internal_state;
+    if (s.texture.id == 0) {
+        return;
+    }
+    const Vector3 car = Car::get_position();
+    const float units_per_pixel = get_units_per_pixel();
+    const float center_x = car.x / units_per_pixel;
+    const float center_z = car.z / units_per_pixel;
+    // the repeat wrap resolves the toroidal tile layout; negative sizes flip both axes so +z points up and +x left, as seen from the chase camera
+    const Rectangle source = {center_x - VIEW_PIXELS * 0.5f, center_z - VIEW_PIXELS * 0.5f, -static_cast<float>(VIEW_PIXELS), -static_cast<float>(VIEW_PIXELS)};
+    const Rectangle dest = {static_cast<float>(GetScreenWidth()) - SCREEN_SIZE - MARGIN, static_cast<float>(GetScreenHeight()) - SCREEN_SIZE - MARGIN, SCREEN_SIZE, SCREEN_SIZE};
+    DrawRectangleRec({dest.x - 2.0f, dest.y - 2.0f, dest.width + 4.0f, dest.height + 4.0f}, DARKGRAY);
+    DrawTexturePro(s.texture, source, dest, {0.0f, 0.0f}, 0.0f, WHITE);
+
+    // the map follows the first car; other players are marked where they are, pinned to the rim once off the map
+    static_assert(MARKER_COLORS.size() >= Car::MAX_PLAYERS);
+    const float screen_per_unit = SCREEN_SIZE / (VIEW_PIXELS * units_per_pixel);
+    for (int32_t player = Car::get_player_count() - 1; player >= 0; --player) {
+        const Vector3 position = Car::get_position(player);
+        // +x is left and +z up on the map
+        const Vector2 center = {
+            Clamp(dest.x + dest.width * 0.5f - (position.x - car.x) * screen_per_unit, dest.x, dest.x + dest.width),
+            Clamp(dest.y + dest.height * 0.5f - (position.z - car.z) * screen_per_unit, dest.y, dest.y + dest.height),
+        };
+        const float heading = Car::get_heading(player);
+        // heading 0 drives towards +z, which is up on the map
+        const Vector2 forward = {-std::sin(heading), -std::cos(heading)};
+        const Vector2 side = {-forward.y, forward.x};
+        const Vector2 back = Vector2Subtract(center, Vector2Scale(forward, 4.0f));
+        // counter-clockwise on screen for any heading, as raylib expects
+        DrawTriangle(Vector2Add(center, Vector2Scale(forward, 7.0f)), Vector2Subtract(back, Vector2Scale(side, 4.0f)), Vector2Add(back, Vector2Scale(side, 4.0f)), MARKER_COLORS[static_cast<size_t>(player)]);
+    }
+}
+
+int64_t get_tile_updates() { return internal_state.tile_updates; }
+
+Color get_pixel(float x, float z) {
+    const float units_per_pixel = get_units_per_pixel();
+    const int32_t px = wrap(static_cast<int32_t>(std::floor(x / units_per_pixel)), MAP_PIXELS);
+    const int32_t pz = wrap(static_cast<int32_t>(std::floor(z / units_per_pixel)), MAP_PIXELS);
+    return internal_state.pixels[static_cast<size_t>(pz * MAP_PIXELS + px)];
+}
+
+void cleanup() {
+    auto &s = internal_state;
+    if (s.texture.id != 0) {
+        UnloadTexture(s.texture);
+    }
+    s = {};
+}
+
+} // namespace Minimap
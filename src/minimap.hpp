@@ -0,0 +1,27 @@
+#pragma once
+
+#include "raylib.h"
+#include <cstdint>
+
+namespace Minimap {
+
+/** rasterizes tiles for chunks that became resident around `car_pos` since the last update; other tiles are left untouched */
+void update(const Vector3 &car_pos);
+
+/** draws the map around the first car, +z up, with a heading marker per player, in the bottom-right corner */
+void draw();
+
+//
+// getters
+//
+
+/** returns how many chunk tiles have been rasterized and uploaded */
+int64_t get_tile_updates();
+
+/** returns the map color at world (x, z), as last rasterized */
+Color get_pixel(float x, float z);
+
+/** frees the map texture */
+void cleanup();
+
+} // namespace Minimap
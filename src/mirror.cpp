@@ -0,0 +1,138 @@
+#include "mirror.hpp"
+#include "car.hpp"
+#include "fog.hpp"
+#include "renderqueue.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace {
+
+constexpr float SCREEN_WIDTH = 0.3f; // on-screen width as a fraction of the window
+constexpr float ASPECT = 3.0f;       // a wide strip, like a real rear-view mirror
+constexpr float MARGIN = 8.0f;
+constexpr float SMOOTHING = 0.1f;      // weight of the newest render in the running average
+constexpr float FRAME_BUDGET_MS = 1.0f; // per-frame share the mirror may cost before its interval grows
+constexpr int32_t MAX_INTERVAL = 8;
+
+struct MirrorState {
+    RenderTexture2D target = {};
+    float resolution = 0.5f;
+    int32_t interval = 2;
+    int64_t frame = 0;
+    int64_t render_count = 0;
+    float average_ms = 0.0f;
+    bool enabled = false;
+} internal_state;
+
+float get_screen_width() { return static_cast<float>(GetScreenWidth()) * SCREEN_WIDTH; }
+
+// the target follows the window size; a smaller resolution only shrinks it, the draw stretches it back
+void ensure_target() {
+    auto &s = internal_state;
+    const int32_t width = std::max(1, static_cast<int32_t>(get_screen_width() * s.resolution));
+    const int32_t height = std::max(1, static_cast<int32_t>(static_cast<float>(width) / ASPECT));
+    if (s.target.id != 0 && s.target.texture.width == width && s.target.texture.height == height) {
+        return;
+    }
+    if (s.target.id != 0) {
+        UnloadRenderTexture(s.target);
+    }
+    s.target = LoadRenderTexture(width, height);
+    SetTextureFilter(s.target.texture, TEXTURE_FILTER_BILINEAR);
+}
+
+// looking backwards from just above the tailgate, level with the road
+Camera3D get_rear_camera() {
+    const Vector3 car = Car::get_position();
+    const float heading = Car::get_heading();
+    const Vector3 forward = {std::sin(heading), 0.0f, std::cos(heading)};
+    const Vector3 eye = {car.x - forward.x * 2.4f, car.y + 1.3f, car.z - forward.z * 2.4f};
+    return {
+        .position = eye,
+        .target = {eye.x - forward.x * 10.0f, eye.y - 0.6f, eye.z - forward.z * 10.0f},
+        .up = {0.0f, 1.0f, 0.0f},
+        .fovy = 30.0f,
+        .projection = CAMERA_PERSPECTIVE,
+    };
+}
+
+} // namespace
+
+namespace Mirror {
+
+void configure(float resolution, int32_t interval) {
+    assert(resolution > 0.0f && resolution <= 1.0f && interval >= 1);
+    auto &s = internal_state;
+    s.resolution = resolution;
+    s.interval = std::min(interval, MAX_INTERVAL);
+    s.enabled = true;
+}
+
+void update() {
+    auto &s = internal_state;
+    if (!s.enabled || !IsWindowReady()) {
+        return;
+    }
+    if (s.frame++ % s.interval != 0) {
+        return;
+    }
+    ensure_target();
+    const double start = GetTime();
+    const Camera3D camera = get_rear_camera();
+    // the items were culled and submitted for the main view, drawing them again costs no streaming or rebuilding
+    Fog::update(camera);
+    BeginTextureMode(s.target);
+    ClearBackground(Fog::get_color());
+    BeginMode3D(camera);
+    RenderQueue::replay(camera);
+    EndMode3D();
+    EndTextureMode();
+    ++s.render_count;
+
+    const auto elapsed = static_cast<float>((GetTime() - start) * 1000.0);
+    s.average_ms += (elapsed - s.average_ms) * SMOOTHING;
+    // refreshing less often keeps the mirror's per-frame share bounded on slow machines
+    if (s.average_ms / static_cast<float>(s.interval) > FRAME_BUDGET_MS && s.interval < MAX_INTERVAL) {
+        ++s.interval;
+    }
+}
+
+void draw() {
+    const auto &s = internal_state;
+    if (!s.enabled || s.target.id == 0) {
+        return;
+    }
+    const float width = get_screen_width();
+    const float height = width / ASPECT;
+    const float x = (static_cast<float>(GetScreenWidth()) - width) * 0.5f;
+    const auto texture_width = static_cast<float>(s.target.texture.width);
+    const auto texture_height = static_cast<float>(s.target.texture.height);
+    // negative width mirrors left and right, negative height undoes the render target's bottom-up rows
+    const Rectangle source = {0.0f, 0.0f, -texture_width, -texture_height};
+    DrawRectangleRec({x - 3.0f, MARGIN - 3.0f, width + 6.0f, height + 6.0f}, DARKGRAY);
+    DrawTexturePro(s.target.texture, source, {x, MARGIN, width, height}, {0.0f, 0.0f}, 0.0f, WHITE);
+}
+
+Vector3 get_position() { return get_rear_camera().position; }
+
+Frustum::Volume get_view() { return Frustum::from_camera(get_rear_camera(), ASPECT); }
+
+bool is_enabled() { return internal_state.enabled; }
+
+int64_t get_render_count() { return internal_state.render_count; }
+
+float get_cost_ms() { return internal_state.average_ms; }
+
+int32_t get_interval() { return internal_state.interval; }
+
+void cleanup() {
+    auto &s = internal_state;
+    if (s.target.id != 0) {
+        UnloadRenderTexture(s.target);
+    }
+    s = {};
+}
+
+} // namespace Mirror
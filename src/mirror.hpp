@@ -0,0 +1,43 @@
+#pragma once
+
+#include "frustum.hpp"
+#include "raylib.h"
+#include <cstdint>
+
+namespace Mirror {
+
+/** enables the mirror, rendered at `resolution` of its on-screen size and refreshed every `interval` frames */
+void configure(float resolution, int32_t interval);
+
+/** re-renders the mirror from behind the car when it is due, replaying the frame's flushed render queue; call outside any texture mode */
+void update();
+
+/** draws the mirror (horizontally flipped) at the top center of the window */
+void draw();
+
+//
+// getters
+//
+
+/** returns the rear camera's eye, which streaming keeps terrain around */
+Vector3 get_position();
+
+/** returns the rear camera's view, so what only the mirror sees is still queued */
+Frustum::Volume get_view();
+
+/** returns whether the mirror is enabled */
+bool is_enabled();
+
+/** returns how many times the mirror has been rendered */
+int64_t get_render_count();
+
+/** returns the running average cpu time of one mirror render (milliseconds) */
+float get_cost_ms();
+
+/** returns the current refresh interval in frames (grows while the per-frame share exceeds its budget) */
+int32_t get_interval();
+
+/** frees the mirror target and disables the mirror */
+void cleanup();
+
+} // namespace Mirror
@@ -0,0 +1,202 @@
+#include "recorder.hpp"
+#include "raylib.h"
+#include "resolution.hpp"
+#include "rlgl.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cinttypes>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace {
+
+constexpr int32_t CAPTURE_INTERVAL = 2; // every other frame, 30 fps at 60
+constexpr int32_t QUEUE_FRAMES = 8;     // frames the encoder may lag behind before captures are dropped
+constexpr float SMOOTHING = 0.1f;       // weight of the newest capture in the running average
+
+struct Frame {
+    std::unique_ptr<uint8_t[]> pixels;
+    int64_t index;
+};
+
+struct RecorderState {
+    std::array<RenderTexture2D, 2> buffers = {}; // the one written this capture and the one read back from the last
+    int32_t width = 0;
+    int32_t height = 0;
+    int64_t frame = 0;
+    int64_t captured = 0;
+    bool pending = false; // the buffer written on the last capture has not been read back yet
+    std::string directory;
+    float capture_ms = 0.0f;
+    std::atomic<int64_t> written = 0;
+    int64_t dropped = 0;
+    bool recording = false;
+
+    // bounded single producer, single consumer queue of preallocated frames
+    std::array<Frame, QUEUE_FRAMES> queue;
+    int64_t head = 0; // next frame to encode
+    int64_t tail = 0; // next free slot
+    std::mutex mutex;
+    std::condition_variable_any ready;
+    std::jthread encoder; // declared last: joined before the queue it drains is destroyed
+} internal_state;
+
+void encode_loop(const std::stop_token &stop) {
+    auto &s = internal_state;
+    while (true) {
+        Frame *frame = nullptr;
+        {
+            std::unique_lock lock(s.mutex);
+            // a stop request still drains what was queued before it
+            s.ready.wait(lock, stop, [&] { return s.head != s.tail; });
+            if (s.head == s.tail) {
+                return;
+            }
+            frame = &s.queue[static_cast<size_t>(s.head % QUEUE_FRAMES)];
+        }
+        const Image image = {.data = frame->pixels.get(), .width = s.width, .height = s.height, .mipmaps = 1, .format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8};
+        const std::string path = s.directory + "/frame_" + std::to_string(frame->index + 100000).substr(1) + ".png";
+        ExportImage(image, path.c_str());
+        ++s.written;
+        std::lock_guard lock(s.mutex);
+        ++s.head;
+    }
+}
+
+// the copy was issued a capture ago, so the gpu has long finished it and reading it back does not wait on the frame in flight
+void read_back(const RenderTexture2D &buffer) {
+    auto &s = internal_state;
+    {
+        std::lock_guard lock(s.mutex);
+        if (s.tail - s.head == QUEUE_FRAMES) {
+            ++s.dropped;
+            return;
+        }
+    }
+    Frame &frame = s.queue[static_cast<size_t>(s.tail % QUEUE_FRAMES)];
+    void *pixels = rlReadTexturePixels(buffer.texture.id, s.width, s.height, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+    if (pixels == nullptr) {
+        return;
+    }
+    std::memcpy(frame.pixels.get(), pixels, static_cast<size_t>(s.width) * static_cast<size_t>(s.height) * 4);
+    RL_FREE(pixels);
+    frame.index = s.captured - 1;
+    {
+        std::lock_guard lock(s.mutex);
+        ++s.tail;
+    }
+    s.ready.notify_one();
+}
+
+} // namespace
+
+namespace Recorder {
+
+bool start(std::string_view directory) {
+#if defined(__EMSCRIPTEN__)
+    (void)directory;
+    TraceLog(LOG_WARNING, "RECORDER: not available without threads");
+    return false;
+#else
+    auto &s = internal_state;
+    if (s.recording || !IsWindowReady()) {
+        return false;
+    }
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    if (error) {
+        TraceLog(LOG_WARNING, "RECORDER: could not create %.*s", static_cast<int32_t>(directory.size()), directory.data());
+        return false;
+    }
+    s.directory = directory;
+    // half the window resolution keeps readback and encoding cheap
+    s.width = std::max(1, GetRenderWidth() / 2);
+    s.height = std::max(1, GetRenderHeight() / 2);
+    for (RenderTexture2D &buffer : s.buffers) {
+        buffer = LoadRenderTexture(s.width, s.height);
+    }
+    for (Frame &frame : s.queue) {
+        frame.pixels = std::make_unique<uint8_t[]>(static_cast<size_t>(s.width) * static_cast<size_t>(s.height) * 4);
+    }
+    s.frame = 0;
+    s.captured = 0;
+    s.pending = false;
+    s.head = 0;
+    s.tail = 0;
+    s.written = 0;
+    s.dropped = 0;
+    s.encoder = std::jthread(encode_loop);
+    s.recording = true;
+    TraceLog(LOG_INFO, "RECORDER: writing %dx%d frames to %s", s.width, s.height, s.directory.c_str());
+    return true;
+#endif
+}
+
+void stop() {
+    auto &s = internal_state;
+    if (!s.recording) {
+        return;
+    }
+    s.recording = false;
+    // the last copy is still waiting for its read back
+    if (s.pending) {
+        read_back(s.buffers[static_cast<size_t>((s.captured - 1) % 2)]);
+        s.pending = false;
+    }
+    s.encoder.request_stop();
+    s.encoder.join();
+    for (RenderTexture2D &buffer : s.buffers) {
+        UnloadRenderTexture(buffer);
+        buffer = {};
+    }
+    TraceLog(LOG_INFO, "RECORDER: wrote %" PRId64 " frames, dropped %" PRId64, s.written.load(), s.dropped);
+}
+
+void capture() {
+    auto &s = internal_state;
+    if (!s.recording || s.frame++ % CAPTURE_INTERVAL != 0) {
+        return;
+    }
+    const double start = GetTime();
+    const int32_t current = static_cast<int32_t>(s.captured % 2);
+    if (s.pending) {
+        read_back(s.buffers[static_cast<size_t>(1 - current)]);
+    }
+    // a gpu-side copy that also downscales; drawn unflipped, so the read back rows come out top-down
+    BeginTextureMode(s.buffers[static_cast<size_t>(current)]);
+    DrawTexturePro(Resolution::get_scene_texture(), Resolution::get_scene_rect(), {0.0f, 0.0f, static_cast<float>(s.width), static_cast<float>(s.height)}, {0.0f, 0.0f}, 0.0f, WHITE);
+    EndTextureMode();
+    s.pending = true;
+    ++s.captured;
+    const auto elapsed = static_cast<float>((GetTime() - start) * 1000.0);
+    s.capture_ms += (elapsed - s.capture_ms) * SMOOTHING;
+}
+
+bool is_recording() { return internal_state.recording; }
+
+int64_t get_written_count() { return internal_state.written; }
+
+int64_t get_dropped_count() { return internal_state.dropped; }
+
+float get_capture_ms() { return internal_state.capture_ms; }
+
+void cleanup() {
+    stop();
+    auto &s = internal_state;
+    for (Frame &frame : s.queue) {
+        frame.pixels.reset();
+    }
+    s.directory.clear();
+}
+
+} // namespace Recorder
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+namespace Recorder {
+
+/** starts writing the scene as a png sequence into `directory` (created if missing); false where threads are unavailable (wasm) */
+bool start(std::string_view directory);
+
+/** stops recording, waiting for the encoder to write every queued frame */
+void stop();
+
+/** copies the finished scene into a capture buffer and queues the one copied on the previous capture; call after the scene is resolved */
+void capture();
+
+//
+// getters
+//
+
+/** returns whether frames are being recorded */
+bool is_recording();
+
+/** returns how many frames have been written to disk */
+int64_t get_written_count();
+
+/** returns how many frames were skipped because the encoder queue was full */
+int64_t get_dropped_count();
+
+/** returns the running average main-thread cost of a capture (milliseconds) */
+float get_capture_ms();
+
+/** stops recording and frees the capture buffers */
+void cleanup();
+
+} // namespace Recorder
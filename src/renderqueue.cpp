@@ -0,0 +1,242 @@
+#include "renderqueue.hpp"
+#include "car.hpp"
+#include "landscape.hpp"
+#include "raymath.h"
+#include "rlgl.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <numeric>
+
+namespace {
+
+// the landscape is the only submitter that grows with the world; the rest is a fixed handful per frame
+constexpr int32_t SKY_ITEMS = 64; // sun and cloud puffs
+constexpr int32_t CAR_ITEMS = 64; // body parts and wheels of one car
+constexpr int32_t CUSTOM_ITEMS = 16;
+constexpr int32_t MAX_ITEMS = Landscape::MAX_ELEMENTS * Landscape::MAX_ITEMS_PER_ELEMENT + SKY_ITEMS + Car::MAX_PLAYERS * CAR_ITEMS + CUSTOM_ITEMS;
+
+enum class Shape : uint8_t { CUSTOM, CUBE, SPHERE, CYLINDER };
+
+struct Item {
+    Vector3 anchor;
+    int32_t sequence;
+    RenderQueue::Pass pass;
+    RenderQueue::State state;
+    Shape shape;
+    int32_t sides;
+    Color color;
+    Matrix transform; // cube only
+    Vector3 a;        // cube: size; sphere: center; cylinder: start
+    Vector3 b;        // cylinder: end
+    float radius_a;
+    float radius_b;
+    void (*draw)(const Camera3D &camera);
+};
+
+struct RenderQueueState {
+    std::array<Item, MAX_ITEMS> items;
+    std::array<int32_t, MAX_ITEMS> order;
+    std::array<uint64_t, MAX_ITEMS> keys; // by item, for the camera of the current draw
+    Item overflow;                        // written and never drawn once the queue is full
+    int32_t count = 0;
+    int32_t dropped = 0;
+    Camera3D camera = {};
+    std::array<Shader, static_cast<size_t>(RenderQueue::State::HORIZON) + 1> shaders = {}; // per state, only read for batched states
+    RenderQueue::Stats stats = {};
+} internal_state;
+
+// pass, then state, then depth: a sorted run only changes state where the pass or the bound state changes.
+// blending is only correct back to front, so the transparent pass sorts on depth and only breaks ties by state.
+// non-negative floats order like their bit patterns, so depth is stored as raw bits (inverted for back to front)
+uint64_t make_key(const Item &item, Vector3 eye) {
+    uint32_t depth = 0;
+    if (item.pass == RenderQueue::Pass::BACKGROUND) {
+        depth = static_cast<uint32_t>(item.sequence);
+    } else {
+        depth = std::bit_cast<uint32_t>(Vector3Distance(item.anchor, eye));
+        if (item.pass == RenderQueue::Pass::TRANSPARENT) {
+            depth = ~depth;
+        }
+    }
+    if (item.pass == RenderQueue::Pass::TRANSPARENT) {
+        return (static_cast<uint64_t>(item.pass) << 48) | (static_cast<uint64_t>(depth) << 8) | static_cast<uint64_t>(item.state);
+    }
+    return (static_cast<uint64_t>(item.pass) << 48) | (static_cast<uint64_t>(item.state) << 40) | depth;
+}
+
+Item &push(RenderQueue::Pass pass, RenderQueue::State state, Vector3 anchor) {
+    auto &s = internal_state;
+    if (s.count == MAX_ITEMS) {
+        ++s.dropped;
+        return s.overflow;
+    }
+    Item &item = s.items[static_cast<size_t>(s.count)];
+    item = {};
+    item.anchor = anchor;
+    item.sequence = s.count;
+    item.pass = pass;
+    item.state = state;
+    ++s.count;
+    return item;
+}
+
+RenderQueue::Pass get_primitive_pass(Color color) { return color.a < 255 ? RenderQueue::Pass::TRANSPARENT : RenderQueue::Pass::OPAQUE; }
+
+bool is_batched(RenderQueue::State state) { return state == RenderQueue::State::BATCH || state == RenderQueue::State::SKY; }
+
+// custom draws bind their own shaders, the batch only ever flushes with the one set here
+void bind_state_shader(RenderQueue::State state) {
+    const Shader &shader = internal_state.shaders[static_cast<size_t>(state)];
+    if (is_batched(state) && shader.id != 0) {
+        BeginShaderMode(shader);
+    } else {
+        EndShaderMode();
+    }
+}
+
+int32_t count_state_changes(const int32_t *order, int32_t count) {
+    const auto &items = internal_state.items;
+    int32_t changes = 0;
+    for (int32_t i = 0; i < count; ++i) {
+        const Item &item = items[static_cast<size_t>(order[i])];
+        const Item *previous = i > 0 ? &items[static_cast<size_t>(order[i - 1])] : nullptr;
+        if (previous == nullptr || previous->pass != item.pass || previous->state != item.state) {
+            ++changes;
+        }
+    }
+    return changes;
+}
+
+void draw_item(const Item &item, const Camera3D &camera) {
+    switch (item.shape) {
+    case Shape::CUSTOM:
+        item.draw(camera);
+        break;
+    case Shape::CUBE:
+        rlPushMatrix();
+        rlMultMatrixf(MatrixToFloat(item.transform));
+        DrawCube({0.0f, 0.0f, 0.0f}, item.a.x, item.a.y, item.a.z, item.color);
+        rlPopMatrix();
+        break;
+    case Shape::SPHERE:
+        DrawSphere(item.a, item.radius_a, item.color);
+        break;
+    case Shape::CYLINDER:
+        DrawCylinderEx(item.a, item.b, item.radius_a, item.radius_b, item.sides, item.color);
+        break;
+    }
+}
+
+// depth keys depend on the eye, so every draw of the same items sorts them again
+void sort_items(Vector3 eye) {
+    auto &s = internal_state;
+    int32_t *order = s.order.data();
+    for (int32_t i = 0; i < s.count; ++i) {
+        s.keys[static_cast<size_t>(i)] = make_key(s.items[static_cast<size_t>(i)], eye);
+    }
+    std::iota(order, order + s.count, 0);
+    std::stable_sort(order, order + s.count, [&](int32_t a, int32_t b) { return s.keys[static_cast<size_t>(a)] < s.keys[static_cast<size_t>(b)]; });
+}
+
+void draw_items(const Camera3D &camera) {
+    auto &s = internal_state;
+    const bool window = IsWindowReady();
+    const Item *previous = nullptr;
+    for (int32_t i = 0; i < s.count; ++i) {
+        const Item &item = s.items[static_cast<size_t>(s.order[static_cast<size_t>(i)])];
+        if (window && (previous == nullptr || previous->pass != item.pass || previous->state != item.state)) {
+            // custom draws bypass the batch, so anything batched so far has to reach the gpu first
+            rlDrawRenderBatchActive();
+            bind_state_shader(item.state);
+            if (item.pass == RenderQueue::Pass::TRANSPARENT) {
+                rlDisableDepthMask();
+            } else {
+                rlEnableDepthMask();
+            }
+        }
+        if (item.shape == Shape::CUSTOM || window) {
+            draw_item(item, camera);
+        }
+        previous = &item;
+    }
+    if (window) {
+        rlDrawRenderBatchActive();
+        EndShaderMode();
+        rlEnableDepthMask();
+    }
+}
+
+} // namespace
+
+namespace RenderQueue {
+
+void begin(const Camera3D &camera) {
+    internal_state.count = 0;
+    internal_state.dropped = 0;
+    internal_state.camera = camera;
+}
+
+void set_shader(State state, Shader shader) {
+    assert(is_batched(state));
+    internal_state.shaders[static_cast<size_t>(state)] = shader;
+}
+
+void submit_cube(const Matrix &transform, Vector3 size, Color color, State state) {
+    assert(is_batched(state));
+    Item &item = push(get_primitive_pass(color), state, {transform.m12, transform.m13, transform.m14});
+    item.shape = Shape::CUBE;
+    item.transform = transform;
+    item.a = size;
+    item.color = color;
+}
+
+void submit_sphere(Vector3 center, float radius, Color color, State state) {
+    assert(is_batched(state));
+    Item &item = push(get_primitive_pass(color), state, center);
+    item.shape = Shape::SPHERE;
+    item.a = center;
+    item.radius_a = radius;
+    item.color = color;
+}
+
+void submit_cylinder(Vector3 start, Vector3 end, float start_radius, float end_radius, int32_t sides, Color color, State state) {
+    assert(is_batched(state));
+    Item &item = push(get_primitive_pass(color), state, Vector3Lerp(start, end, 0.5f));
+    item.shape = Shape::CYLINDER;
+    item.a = start;
+    item.b = end;
+    item.radius_a = start_radius;
+    item.radius_b = end_radius;
+    item.sides = sides;
+    item.color = color;
+}
+
+void submit_custom(Pass pass, State state, Vector3 anchor, void (*draw)(const Camera3D &camera)) {
+    Item &item = push(pass, state, anchor);
+    item.shape = Shape::CUSTOM;
+    item.draw = draw;
+}
+
+void flush() {
+    auto &s = internal_state;
+    int32_t *order = s.order.data();
+    std::iota(order, order + s.count, 0);
+    s.stats.items = s.count;
+    s.stats.dropped = s.dropped;
+    s.stats.submitted_state_changes = count_state_changes(order, s.count);
+    sort_items(s.camera.position);
+    s.stats.sorted_state_changes = count_state_changes(order, s.count);
+    draw_items(s.camera);
+}
+
+void replay(const Camera3D &camera) {
+    sort_items(camera.position);
+    draw_items(camera);
+}
+
+Stats get_stats() { return internal_state.stats; }
+
+} // namespace RenderQueue
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "raylib.h"
+#include <cstdint>
+
+namespace RenderQueue {
+
+/** passes run in this order; primitives are opaque or transparent by their color's alpha */
+enum class Pass : uint8_t {
+    BACKGROUND,  // drawn first, in submission order
+    OPAQUE,      // front to back, so early depth testing rejects hidden fragments
+    TRANSPARENT, // back to front with depth writes off, so blending composites correctly
+};
+
+/** gpu state an item binds; items sharing a state are drawn back to back, in this order within the background and
+    opaque passes (transparent items keep strict depth order and only group states at equal depth) */
+enum class State : uint8_t {
+    TERRAIN, // terrain shader, diffuse and normal atlas; first, as it occludes the most
+    TRAFFIC, // instanced npc cars
+    BATCH,   // raylib's immediate-mode batch with the shader set for it (default texture)
+    SKY,     // the batch again, with the default shader: sun and clouds are not fogged
+    HORIZON, // horizon panorama
+};
+
+/** state changes of the last flushed frame, in submission order and after sorting */
+struct Stats {
+    int32_t items;
+    int32_t submitted_state_changes;
+    int32_t sorted_state_changes;
+    int32_t dropped; // submitted past the queue's capacity, so not drawn
+};
+
+/** starts a frame seen from `camera`; everything submitted until `flush` is sorted against it */
+void begin(const Camera3D &camera);
+
+/** sets the shader batched primitives of `state` are drawn with (`BATCH` or `SKY`); a zero id selects raylib's default */
+void set_shader(State state, Shader shader);
+
+/** queues a cube of `size` centered at the origin of `transform` */
+void submit_cube(const Matrix &transform, Vector3 size, Color color, State state = State::BATCH);
+
+/** queues a sphere */
+void submit_sphere(Vector3 center, float radius, Color color, State state = State::BATCH);
+
+/** queues a (possibly tapered) cylinder between two world points */
+void submit_cylinder(Vector3 start, Vector3 end, float start_radius, float end_radius, int32_t sides, Color color, State state = State::BATCH);
+
+/** queues a subsystem's own draw; `anchor` is the world point it is depth sorted by */
+void submit_custom(Pass pass, State state, Vector3 anchor, void (*draw)(const Camera3D &camera));
+
+/** sorts and draws everything queued since `begin` (custom items always run, primitives only with a window) */
+void flush();
+
+/** draws the items of the last flush again from another camera, sorted for it; they stay queued until the next `begin` */
+void replay(const Camera3D &camera);
+
+/** returns the stats of the last flush */
+Stats get_stats();
+
+} // namespace RenderQueue
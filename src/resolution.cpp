@@ -0,0 +1,111 @@
+#include "resolution.hpp"
+#include "rlgl.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+
+namespace {
+
+constexpr float DEFAULT_BUDGET = 1.0f / 60.0f;
+constexpr float MIN_SCALE = 0.5f;
+constexpr float MAX_SCALE = 1.0f;
+constexpr float SMOOTHING = 0.1f;  // weight of the newest frame in the running average
+constexpr float STEP_DOWN = 0.95f; // per frame while over budget
+constexpr float STEP_UP = 1.02f;   // per frame while comfortably under budget
+constexpr float HEADROOM = 0.85f;  // fraction of the budget below which resolution is allowed back up
+
+struct ResolutionState {
+    RenderTexture2D target = {};
+    float budget = DEFAULT_BUDGET;
+    float average = DEFAULT_BUDGET * HEADROOM;
+    float scale = MAX_SCALE;
+    bool active = false; // a begin() is waiting for its end()
+} internal_state;
+
+// the target always matches the full render size; lower scales only shrink the viewport into it,
+// so a changing scale never reallocates gpu memory
+void ensure_target() {
+    auto &s = internal_state;
+    const int32_t width = GetRenderWidth();
+    const int32_t height = GetRenderHeight();
+    if (s.target.id != 0 && s.target.texture.width == width && s.target.texture.height == height) {
+        return;
+    }
+    if (s.target.id != 0) {
+        UnloadRenderTexture(s.target);
+    }
+    s.target = LoadRenderTexture(width, height);
+    SetTextureFilter(s.target.texture, TEXTURE_FILTER_BILINEAR);
+}
+
+int32_t scaled(int32_t size) { return std::max(1, static_cast<int32_t>(std::lround(static_cast<float>(size) * internal_state.scale))); }
+
+} // namespace
+
+namespace Resolution {
+
+void begin() {
+    auto &s = internal_state;
+    assert(!s.active && "begin() called twice");
+    if (!IsWindowReady()) {
+        return;
+    }
+    ensure_target();
+    BeginTextureMode(s.target);
+    // BeginMode3D takes its aspect ratio from the full target, which the uniform scale preserves
+    rlViewport(0, 0, scaled(s.target.texture.width), scaled(s.target.texture.height));
+    s.active = true;
+}
+
+void end() {
+    auto &s = internal_state;
+    if (!s.active) {
+        return;
+    }
+    s.active = false;
+    EndTextureMode();
+    const Rectangle scene = get_scene_rect();
+    // render targets are stored bottom-up, and the scaled region sits in the bottom-left corner
+    const Rectangle source = {0.0f, 0.0f, scene.width, -scene.height};
+    const Rectangle dest = {0.0f, 0.0f, static_cast<float>(GetScreenWidth()), static_cast<float>(GetScreenHeight())};
+    DrawTexturePro(s.target.texture, source, dest, {0.0f, 0.0f}, 0.0f, WHITE);
+}
+
+float update(float frame_seconds) {
+    auto &s = internal_state;
+    assert(frame_seconds >= 0.0f);
+    s.average += (frame_seconds - s.average) * SMOOTHING;
+    // fill cost follows the pixel count, so small multiplicative steps converge without oscillating
+    if (s.average > s.budget) {
+        s.scale = std::max(MIN_SCALE, s.scale * STEP_DOWN);
+    } else if (s.average < s.budget * HEADROOM) {
+        s.scale = std::min(MAX_SCALE, s.scale * STEP_UP);
+    }
+    return s.scale;
+}
+
+void set_budget(float seconds) {
+    assert(seconds > 0.0f);
+    internal_state.budget = seconds;
+}
+
+float get_scale() { return internal_state.scale; }
+
+Texture2D get_scene_texture() { return internal_state.target.texture; }
+
+Rectangle get_scene_rect() {
+    const auto &s = internal_state;
+    return {0.0f, 0.0f, static_cast<float>(scaled(s.target.texture.width)), static_cast<float>(scaled(s.target.texture.height))};
+}
+
+void cleanup() {
+    auto &s = internal_state;
+    if (s.target.id != 0) {
+        UnloadRenderTexture(s.target);
+    }
+    s = {};
+}
+
+} // namespace Resolution
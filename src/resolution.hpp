@@ -0,0 +1,35 @@
+#pragma once
+
+#include "raylib.h"
+
+namespace Resolution {
+
+/** redirects drawing into the offscreen scene target, restricted to the current render scale */
+void begin();
+
+/** ends the scene target and stretches its scaled region over the whole window */
+void end();
+
+/** feeds the last frame time into the controller and returns the render scale for the next frame */
+float update(float frame_seconds);
+
+/** sets the frame time the controller steers towards (seconds) */
+void set_budget(float seconds);
+
+//
+// getters
+//
+
+/** returns the fraction of the window resolution the scene is rendered at, per axis */
+float get_scale();
+
+/** returns the offscreen scene target's texture (rows stored bottom-up) */
+Texture2D get_scene_texture();
+
+/** returns the part of the scene texture the last frame was rendered into */
+Rectangle get_scene_rect();
+
+/** frees the scene target */
+void cleanup();
+
+} // namespace Resolution
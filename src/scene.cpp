@@ -0,0 +1,30 @@
+#include "scene.hpp"
+#include "car.hpp"
+#include "fog.hpp"
+#include "horizon.hpp"
+#include "landscape.hpp"
+#include "renderqueue.hpp"
+#include "sky.hpp"
+#include "terrain.hpp"
+#include "traffic.hpp"
+
+namespace Scene {
+
+// the app and the golden-image test both draw through here, so the goldens cover exactly what players see
+void draw(const Camera3D &camera, std::span<const Frustum::Volume> views, int32_t player) {
+    Fog::update(camera);
+    Horizon::select(player);
+    ClearBackground(Fog::get_color());
+    BeginMode3D(camera);
+    RenderQueue::begin(camera);
+    RenderQueue::submit_custom(RenderQueue::Pass::BACKGROUND, RenderQueue::State::HORIZON, camera.position, Horizon::draw);
+    Sky::draw(camera);
+    RenderQueue::submit_custom(RenderQueue::Pass::OPAQUE, RenderQueue::State::TERRAIN, camera.position, Terrain::draw);
+    RenderQueue::submit_custom(RenderQueue::Pass::OPAQUE, RenderQueue::State::TRAFFIC, camera.position, Traffic::draw);
+    Landscape::draw(views);
+    Car::draw();
+    RenderQueue::flush();
+    EndMode3D();
+}
+
+} // namespace Scene
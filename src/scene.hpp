@@ -0,0 +1,15 @@
+#pragma once
+
+#include "frustum.hpp"
+#include "raylib.h"
+#include <cstdint>
+#include <span>
+
+namespace Scene {
+
+/** clears the current target to the fog color and draws the world as seen from `camera`, behind `player`'s horizon;
+    `views` decide which landscape elements are queued, so views replaying the queue later (the mirror) get what they
+    see too */
+void draw(const Camera3D &camera, std::span<const Frustum::Volume> views, int32_t player = 0);
+
+} // namespace Scene
@@ -1,5 +1,6 @@
 #include "sky.hpp"
 #include "raymath.h"
+#include "renderqueue.hpp"
 
 #include <cmath>
 #include <cstdint>
@@ -35,9 +36,9 @@ void draw_sun(const Vector3 &camera_pos) {
 
     constexpr Color SUN_COLOR = {255, 230, 100, 255};
     constexpr Color GLOW_COLOR = {255, 200, 50, 128};
-    DrawSphere(sun_pos, SUN_RADIUS * 1.5f, GLOW_COLOR);
-    DrawSphere(sun_pos, SUN_RADIUS * 1.2f, GLOW_COLOR);
-    DrawSphere(sun_pos, SUN_RADIUS, SUN_COLOR);
+    RenderQueue::submit_sphere(sun_pos, SUN_RADIUS * 1.5f, GLOW_COLOR, RenderQueue::State::SKY);
+    RenderQueue::submit_sphere(sun_pos, SUN_RADIUS * 1.2f, GLOW_COLOR, RenderQueue::State::SKY);
+    RenderQueue::submit_sphere(sun_pos, SUN_RADIUS, SUN_COLOR, RenderQueue::State::SKY);
 }
 
 void draw_cloud(const Vector3 &camera_pos, const Cloud &cloud) {
@@ -53,26 +54,26 @@ void draw_cloud(const Vector3 &camera_pos, const Cloud &cloud) {
     float base_radius = 15.0f * cloud.scale;
 
     // fluffy cloud
-    DrawSphere(base_pos, base_radius, CLOUD_COLOR);
+    RenderQueue::submit_sphere(base_pos, base_radius, CLOUD_COLOR, RenderQueue::State::SKY);
 
     // side puffs
     Vector3 left = base_pos;
     left.x -= base_radius * 0.7f * cloud.stretch;
-    DrawSphere(left, base_radius * 0.8f, CLOUD_COLOR);
+    RenderQueue::submit_sphere(left, base_radius * 0.8f, CLOUD_COLOR, RenderQueue::State::SKY);
 
     Vector3 right = base_pos;
     right.x += base_radius * 0.8f * cloud.stretch;
-    DrawSphere(right, base_radius * 0.75f, CLOUD_COLOR);
+    RenderQueue::submit_sphere(right, base_radius * 0.75f, CLOUD_COLOR, RenderQueue::State::SKY);
 
     // top puffs
     Vector3 top = base_pos;
     top.y += base_radius * 0.5f;
-    DrawSphere(top, base_radius * 0.7f, CLOUD_COLOR);
+    RenderQueue::submit_sphere(top, base_radius * 0.7f, CLOUD_COLOR, RenderQueue::State::SKY);
 
     // bottom shadow
     Vector3 bottom = base_pos;
     bottom.y -= base_radius * 0.3f;
-    DrawSphere(bottom, base_radius * 0.6f, CLOUD_SHADOW);
+    RenderQueue::submit_sphere(bottom, base_radius * 0.6f, CLOUD_SHADOW, RenderQueue::State::SKY);
 }
 
 } // namespace
@@ -4,7 +4,7 @@
 
 namespace Sky {
 
-/** draws the sky elements (sun and clouds) */
+/** queues the sky elements (sun and clouds) for drawing */
 void draw(const Camera3D &camera);
 
 } // namespace Sky
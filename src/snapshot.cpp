@@ -0,0 +1,119 @@
+#include "snapshot.hpp"
+#include "camera.hpp"
+#include "car.hpp"
+#include "landscape.hpp"
+#include "raylib.h"
+#include "terrain.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <vector>
+
+namespace {
+
+constexpr std::array<char, 8> MAGIC = {'S', 'R', 'S', 'N', 'A', 'P', 'S', '1'};
+
+// the payload is the modules' sections back to back; the header rejects foreign, stale and damaged files up front
+struct Header {
+    std::array<char, 8> magic;
+    int32_t resolution; // vertices along a chunk edge
+    float chunk_size;
+    uint64_t payload_size;
+    uint64_t checksum; // fnv-1a over the payload
+};
+static_assert(sizeof(Header) == 32);
+
+uint64_t get_checksum(std::span<const std::byte> bytes) {
+    uint64_t hash = 14695981039346656037ull;
+    for (const std::byte b : bytes) {
+        hash = (hash ^ static_cast<uint64_t>(b)) * 1099511628211ull;
+    }
+    return hash;
+}
+
+} // namespace
+
+namespace Snapshot {
+
+bool save(std::string_view path) {
+    Writer writer;
+    Car::save(writer);
+    writer.write(Cam::get_cameras());
+    Terrain::save(writer);
+    Landscape::save(writer);
+
+    // written next to the target and renamed over it, so a failed save never truncates the previous snapshot
+    const std::string file_path(path);
+    const std::string temp_path = file_path + ".tmp";
+    std::unique_ptr<std::FILE, decltype(&std::fclose)> file(std::fopen(temp_path.c_str(), "wb"), &std::fclose);
+    if (!file) {
+        return false;
+    }
+    const Header header = {
+        .magic = MAGIC,
+        .resolution = Terrain::get_chunk_resolution(),
+        .chunk_size = Terrain::get_chunk_size(),
+        .payload_size = writer.bytes.size(),
+        .checksum = get_checksum(writer.bytes),
+    };
+    const bool written = std::fwrite(&header, sizeof(header), 1, file.get()) == 1 && std::fwrite(writer.bytes.data(), 1, writer.bytes.size(), file.get()) == writer.bytes.size();
+    std::error_code error;
+    if (std::fclose(file.release()) != 0 || !written) {
+        std::filesystem::remove(temp_path, error);
+        return false;
+    }
+    std::filesystem::rename(temp_path, file_path, error);
+    if (error) {
+        std::filesystem::remove(temp_path, error);
+        return false;
+    }
+    TraceLog(LOG_INFO, "SNAPSHOT: saved %d chunks, %d elements (%zu KB)", Terrain::get_resident_count(), Landscape::get_count(), (sizeof(header) + writer.bytes.size()) / 1024);
+    return true;
+}
+
+bool load(std::string_view path) {
+    const std::string file_path(path);
+    std::error_code error;
+    const uintmax_t file_size = std::filesystem::file_size(file_path, error);
+    const std::unique_ptr<std::FILE, decltype(&std::fclose)> file(std::fopen(file_path.c_str(), "rb"), &std::fclose);
+    Header header = {};
+    if (error || !file || std::fread(&header, sizeof(header), 1, file.get()) != 1) {
+        return false;
+    }
+    const bool compatible = header.magic == MAGIC && header.resolution == Terrain::get_chunk_resolution() && header.chunk_size == Terrain::get_chunk_size();
+    if (!compatible || file_size != sizeof(Header) + header.payload_size) {
+        return false;
+    }
+    std::vector<std::byte> payload(header.payload_size);
+    if (std::fread(payload.data(), 1, payload.size(), file.get()) != payload.size() || get_checksum(payload) != header.checksum) {
+        return false;
+    }
+
+    // every section is read and checked before any is applied, so a bad landscape can't leave a half-restored car
+    Reader reader = {.bytes = payload};
+    const Restore car = Car::load(reader);
+    std::array<Camera3D, Car::MAX_PLAYERS> cameras = {};
+    if (!car || !reader.read(cameras)) {
+        return false;
+    }
+    const Restore terrain = Terrain::load(reader);
+    const Restore landscape = terrain ? Landscape::load(reader) : Restore();
+    if (!terrain || !landscape || reader.get_remaining() != 0) {
+        return false;
+    }
+    // applied in the order they were written, the cars first so streaming starts around them
+    car();
+    Cam::get_cameras() = cameras;
+    terrain();
+    landscape();
+    TraceLog(LOG_INFO, "SNAPSHOT: restored %d chunks, %d elements", Terrain::get_resident_count(), Landscape::get_count());
+    return true;
+}
+
+} // namespace Snapshot
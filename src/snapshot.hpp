@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <span>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace Snapshot {
+
+/** append-only buffer the modules write their state into, field by field in native layout */
+struct Writer {
+    std::vector<std::byte> bytes;
+
+    template <typename T> void write(const T &value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        write_bytes(std::as_bytes(std::span(&value, 1)));
+    }
+
+    void write_bytes(std::span<const std::byte> data) { bytes.insert(bytes.end(), data.begin(), data.end()); }
+};
+
+/** reads back what a `Writer` wrote, in the same order; every read fails instead of running past the end */
+struct Reader {
+    std::span<const std::byte> bytes;
+    size_t offset = 0;
+
+    template <typename T> [[nodiscard]] bool read(T &value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        return read_bytes(std::as_writable_bytes(std::span(&value, 1)));
+    }
+
+    [[nodiscard]] bool read_bytes(std::span<std::byte> data) {
+        if (data.size() > get_remaining()) {
+            return false;
+        }
+        std::memcpy(data.data(), bytes.data() + offset, data.size());
+        offset += data.size();
+        return true;
+    }
+
+    [[nodiscard]] bool skip(size_t size) {
+        if (size > get_remaining()) {
+            return false;
+        }
+        offset += size;
+        return true;
+    }
+
+    size_t get_remaining() const { return bytes.size() - offset; }
+};
+
+/** applies a section a module has read and fully checked, or is empty if the section was malformed. it may still view
+    the reader's bytes, so it has to run while they are alive */
+using Restore = std::function<void()>;
+
+/** writes the car(s), cameras, resident chunk heightfields, landscape elements and the landscape rng to `path`. the
+    file is written next to it and renamed into place, so a failed save keeps the previous snapshot; returns false on
+    i/o failure */
+bool save(std::string_view path);
+
+/** restores everything `save` wrote, so the next update continues exactly where the saved session stopped. the file
+    (format, chunk layout, checksum) and every section are checked before anything is applied; returns false, changing
+    nothing, if it is missing or rejected */
+bool load(std::string_view path);
+
+} // namespace Snapshot
@@ -0,0 +1,82 @@
+#include "splitscreen.hpp"
+#include "car.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+
+namespace {
+
+constexpr float DIVIDER = 4.0f;
+
+struct SplitScreenState {
+    // one target per view, so BeginMode3D picks up each half's own aspect
+    std::array<RenderTexture2D, Car::MAX_PLAYERS> targets = {};
+    bool enabled = false;
+} internal_state;
+
+int32_t get_view_width() { return std::max(1, GetRenderWidth() / Car::MAX_PLAYERS); }
+
+int32_t get_view_height() { return std::max(1, GetRenderHeight()); }
+
+// the targets follow the window size
+void ensure_target(RenderTexture2D &target) {
+    const int32_t width = get_view_width();
+    const int32_t height = get_view_height();
+    if (target.id != 0 && target.texture.width == width && target.texture.height == height) {
+        return;
+    }
+    if (target.id != 0) {
+        UnloadRenderTexture(target);
+    }
+    target = LoadRenderTexture(width, height);
+}
+
+} // namespace
+
+namespace SplitScreen {
+
+void enable() { internal_state.enabled = true; }
+
+void begin_view(int32_t view) {
+    assert(view >= 0 && view < Car::MAX_PLAYERS);
+    if (!IsWindowReady()) {
+        return;
+    }
+    RenderTexture2D &target = internal_state.targets[static_cast<size_t>(view)];
+    ensure_target(target);
+    BeginTextureMode(target);
+}
+
+void end_view() {
+    if (IsWindowReady()) {
+        EndTextureMode();
+    }
+}
+
+void draw() {
+    const auto width = static_cast<float>(GetScreenWidth()) / Car::MAX_PLAYERS;
+    const auto height = static_cast<float>(GetScreenHeight());
+    for (size_t view = 0; view < internal_state.targets.size(); ++view) {
+        const Texture2D &texture = internal_state.targets[view].texture;
+        // negative height undoes the render target's bottom-up rows
+        const Rectangle source = {0.0f, 0.0f, static_cast<float>(texture.width), -static_cast<float>(texture.height)};
+        DrawTexturePro(texture, source, {width * static_cast<float>(view), 0.0f, width, height}, {0.0f, 0.0f}, 0.0f, WHITE);
+    }
+    DrawRectangleRec({width - DIVIDER * 0.5f, 0.0f, DIVIDER, height}, DARKGRAY);
+}
+
+bool is_enabled() { return internal_state.enabled; }
+
+float get_aspect() { return static_cast<float>(get_view_width()) / static_cast<float>(get_view_height()); }
+
+void cleanup() {
+    for (RenderTexture2D &target : internal_state.targets) {
+        if (target.id != 0) {
+            UnloadRenderTexture(target);
+        }
+    }
+    internal_state = {};
+}
+
+} // namespace SplitScreen
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "raylib.h"
+#include <cstdint>
+
+namespace SplitScreen {
+
+/** splits the window into one view per player, side by side */
+void enable();
+
+/** redirects drawing into `view`'s half-window target; call inside BeginDrawing, outside any other texture mode */
+void begin_view(int32_t view);
+
+/** ends the current view's target */
+void end_view();
+
+/** draws both views side by side with a divider */
+void draw();
+
+//
+// getters
+//
+
+/** returns whether split-screen is on */
+bool is_enabled();
+
+/** returns one view's width over height */
+float get_aspect();
+
+/** frees the view targets */
+void cleanup();
+
+} // namespace SplitScreen
@@ -1,12 +1,26 @@
 #include "terrain.hpp"
+#include "atlas.hpp"
+#include "fog.hpp"
+#include "frustum.hpp"
+#include "glsl.hpp"
+#include "heightcache.hpp"
+#include "heightring.hpp"
+#include "jobs.hpp"
 #include "raymath.h"
 #include "rlgl.h"
 
 #include <algorithm>
 #include <array>
+#include <cassert>
 #include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
 #include <numeric>
+#include <optional>
 #include <random>
+#include <tuple>
 
 namespace {
 
@@ -17,17 +31,137 @@ constexpr float ROAD_AMPLITUDE = 200.0f;
 constexpr int32_t GRID_SIZE = 64;
 constexpr float TILE_SIZE = 1.0f;
 constexpr float CHUNK_SIZE = (GRID_SIZE - 1) * TILE_SIZE;
+constexpr int32_t CHUNK_RADIUS = 2;
+constexpr int32_t CLIPMAP_LEVELS = 6; // 254 * 2^5 units, about 8 km across
+
+// one contiguous slab per chunk holding all five mesh arrays back to back
+constexpr size_t VERTEX_COUNT = GRID_SIZE * GRID_SIZE;
+constexpr size_t INDEX_COUNT = (GRID_SIZE - 1) * (GRID_SIZE - 1) * 6;
+constexpr size_t SLAB_NORMALS_OFFSET = VERTEX_COUNT * 3 * sizeof(float);
+constexpr size_t SLAB_TEXCOORDS_OFFSET = SLAB_NORMALS_OFFSET + VERTEX_COUNT * 3 * sizeof(float);
+constexpr size_t SLAB_COLORS_OFFSET = SLAB_TEXCOORDS_OFFSET + VERTEX_COUNT * 2 * sizeof(float);
+constexpr size_t SLAB_INDICES_OFFSET = SLAB_COLORS_OFFSET + VERTEX_COUNT * 4 * sizeof(unsigned char);
+constexpr size_t SLAB_SIZE = (SLAB_INDICES_OFFSET + INDEX_COUNT * sizeof(unsigned short) + 15) & ~size_t{15};
+constexpr int32_t WINDOW_CHUNKS = (2 * CHUNK_RADIUS + 1) * (2 * CHUNK_RADIUS + 1);
+constexpr int32_t MAX_FOCI = 8;
+constexpr int32_t SLAB_COUNT = 2 * WINDOW_CHUNKS; // two disjoint windows, more foci share or compete for them
+
+// per-chunk normal texture; texel centers sit on the vertices, so shading detail no longer depends on
+// the mesh being lit per vertex and the generated normals are packed as is
+constexpr int32_t NORMAL_MAP_SIZE = GRID_SIZE;
+
+// all chunk vertex data lives in one gpu buffer per attribute with one slot per slab. 16-bit indices
+// reach 65536 vertices, so slots are grouped into pages that each bind the buffers at their own base
+constexpr int32_t PAGE_SLOTS = static_cast<int32_t>(65536 / VERTEX_COUNT);
+constexpr int32_t PAGE_COUNT = (SLAB_COUNT + PAGE_SLOTS - 1) / PAGE_SLOTS;
+constexpr int32_t ATLAS_TILES = 8; // normal maps share one texture, a tile per slot
+static_assert(ATLAS_TILES * ATLAS_TILES >= SLAB_COUNT);
+constexpr int32_t ATLAS_SIZE = ATLAS_TILES * NORMAL_MAP_SIZE;
+
+// per-chunk min/max height pyramid for raycasts: the base holds one cell per quad, padded from 63 to 64 per edge
+// with empty cells, and each level above halves the resolution down to one cell for the whole chunk
+constexpr int32_t PYRAMID_BASE = GRID_SIZE;
+constexpr int32_t PYRAMID_LEVELS = 7;
+static_assert(1 << (PYRAMID_LEVELS - 1) == PYRAMID_BASE);
+
+constexpr size_t pyramid_offset(int32_t level) {
+    size_t offset = 0;
+    for (int32_t l = 0; l < level; ++l) {
+        const auto dim = static_cast<size_t>(PYRAMID_BASE >> l);
+        offset += dim * dim;
+    }
+    return offset;
+}
+constexpr size_t PYRAMID_NODES = pyramid_offset(PYRAMID_LEVELS);
+
+// light direction matches the sun in sky.cpp
+constexpr Vector3 LIGHT_DIRECTION = {0.7790f, 0.3304f, 0.5329f};
+
+constexpr const char *TERRAIN_VS = GLSL_VERSION FOG_GLSL R"(
+in_attr vec3 vertexPosition;
+in_attr vec2 vertexTexCoord;
+in_attr vec4 vertexColor;
+uniform mat4 mvp;
+out_var vec2 fragTexCoord;
+out_var vec4 fragColor;
+out_var float fragFog;
+void main() {
+    fragTexCoord = vertexTexCoord;
+    fragColor = vertexColor;
+    fragFog = fog_factor(vertexPosition);
+    gl_Position = mvp * vec4(vertexPosition, 1.0);
+}
+)";
+
+constexpr const char *TERRAIN_FS = GLSL_VERSION GLSL_FRAG_OUT R"(
+in_var vec2 fragTexCoord;
+in_var vec4 fragColor;
+in_var float fragFog;
+uniform sampler2D texture0;
+uniform sampler2D texture2;
+uniform vec4 colDiffuse;
+uniform vec3 lightDirection;
+uniform vec3 fogColor;
+void main() {
+    vec3 normal = normalize(texture(texture2, fragTexCoord).rgb * 2.0 - 1.0);
+    float light = 0.55 + 0.6 * max(dot(normal, lightDirection), 0.0);
+    vec4 base = texture(texture0, fragTexCoord) * colDiffuse * fragColor;
+    FRAG_COLOR = vec4(mix(base.rgb * light, fogColor, fragFog), base.a);
+}
+)";
 
 struct TerrainChunk {
     int cx;
     int cz;
-    Model model;
+    int32_t slab;
+    Mesh mesh; // cpu side, backed by a pool slab or a baked atlas tile; the gpu copy lives in the slab's buffer slot
+};
+
+struct ChunkBuffers {
+    unsigned int positions = 0; // world-space, so a run of slots draws without per-chunk uniforms
+    unsigned int texcoords = 0; // static, each slot addresses its tile of the normal atlas
+    unsigned int colors = 0;
+    unsigned int indices = 0; // one page worth of grids, biased per slot
+    std::array<unsigned int, PAGE_COUNT> vaos = {};
+    Texture2D normal_atlas = {};
+    std::unique_ptr<float[]> positions_staging;
+    std::array<unsigned char, NORMAL_MAP_SIZE * NORMAL_MAP_SIZE * 4> normal_map_staging = {};
+};
+
+struct HeightPyramid {
+    std::array<float, PYRAMID_NODES> min;
+    std::array<float, PYRAMID_NODES> max;
+};
+
+// cpu memory a resident chunk holds, counted against the memory cap
+constexpr size_t CHUNK_BYTES = SLAB_SIZE + sizeof(HeightPyramid);
+
+// what a snapshot keeps of a chunk: x and z follow from the grid, normals are packed to a byte per component
+struct ChunkRecord {
+    int32_t cx;
+    int32_t cz;
+    std::array<float, VERTEX_COUNT> heights;
+    std::array<int8_t, VERTEX_COUNT * 3> normals;
+    std::array<unsigned char, VERTEX_COUNT * 3> colors;
+};
+
+struct SlabPool {
+    std::unique_ptr<std::byte[]> memory;
+    std::unique_ptr<HeightPyramid[]> pyramids; // one per slab, rebuilt with the chunk
+    std::array<int32_t, SLAB_COUNT> free_slabs;
+    int32_t free_count = 0;
 };
 
 struct TerrainState {
     std::vector<TerrainChunk> chunks;
+    SlabPool pool;
     Texture2D texture = {};
+    Shader shader = {}; // shared by every chunk, bound once per draw
+    ChunkBuffers buffers;
+    Terrain::DrawStats draw_stats = {};
+    size_t memory_cap = SIZE_MAX;
     float chunk_size = 0.0f;
+    Terrain::Representation representation = Terrain::Representation::CHUNKS;
     Vector3 start_pos = {};
     float start_heading = 0.0f;
     bool initialized = false;
@@ -35,15 +169,169 @@ struct TerrainState {
 
 float get_road_center_x(float z); // forward declaration
 
+// points the shader attributes at one page of the shared buffers
+void bind_page_attributes(int32_t page) {
+    const ChunkBuffers &b = internal_state.buffers;
+    const int *locs = internal_state.shader.locs;
+    const int32_t base = page * PAGE_SLOTS * static_cast<int32_t>(VERTEX_COUNT);
+    const auto bind = [&](int32_t loc, unsigned int vbo, int32_t size, int32_t type, bool normalized, int32_t stride) {
+        if (loc < 0) {
+            return;
+        }
+        rlEnableVertexBuffer(vbo);
+        rlSetVertexAttribute(static_cast<unsigned int>(loc), size, type, normalized, 0, base * stride);
+        rlEnableVertexAttribute(static_cast<unsigned int>(loc));
+    };
+    bind(locs[SHADER_LOC_VERTEX_POSITION], b.positions, 3, RL_FLOAT, false, 3 * sizeof(float));
+    bind(locs[SHADER_LOC_VERTEX_TEXCOORD01], b.texcoords, 2, RL_FLOAT, false, 2 * sizeof(float));
+    bind(locs[SHADER_LOC_VERTEX_COLOR], b.colors, 4, RL_UNSIGNED_BYTE, true, 4);
+    rlEnableVertexBufferElement(b.indices);
+}
+
+void bind_page(int32_t page) {
+    // without vertex array objects (some webgl 1 contexts) the attribute layout is re-specified per page
+    if (!rlEnableVertexArray(internal_state.buffers.vaos[static_cast<size_t>(page)])) {
+        bind_page_attributes(page);
+    }
+}
+
+void load_chunk_buffers() {
+    ChunkBuffers &b = internal_state.buffers;
+    constexpr size_t SLOT_VERTICES = SLAB_COUNT * VERTEX_COUNT;
+    b.positions = rlLoadVertexBuffer(nullptr, static_cast<int>(SLOT_VERTICES * 3 * sizeof(float)), true);
+    b.colors = rlLoadVertexBuffer(nullptr, static_cast<int>(SLOT_VERTICES * 4), true);
+
+    const auto texcoords = std::make_unique<float[]>(SLOT_VERTICES * 2);
+    for (int32_t slot = 0; slot < SLAB_COUNT; ++slot) {
+        const int32_t tile_x = (slot % ATLAS_TILES) * NORMAL_MAP_SIZE;
+        const int32_t tile_z = (slot / ATLAS_TILES) * NORMAL_MAP_SIZE;
+        for (int z = 0; z < GRID_SIZE; ++z) {
+            for (int x = 0; x < GRID_SIZE; ++x) {
+                const size_t i = static_cast<size_t>(slot) * VERTEX_COUNT + static_cast<size_t>(z * GRID_SIZE + x);
+                texcoords[i * 2] = (static_cast<float>(tile_x + x) + 0.5f) / ATLAS_SIZE;
+                texcoords[i * 2 + 1] = (static_cast<float>(tile_z + z) + 0.5f) / ATLAS_SIZE;
+            }
+        }
+    }
+    b.texcoords = rlLoadVertexBuffer(texcoords.get(), static_cast<int>(SLOT_VERTICES * 2 * sizeof(float)), false);
+
+    // slot k of a page uses the slab grid shifted by k chunks worth of vertices
+    const auto indices = std::make_unique<unsigned short[]>(PAGE_SLOTS * INDEX_COUNT);
+    const auto *grid = reinterpret_cast<const unsigned short *>(internal_state.pool.memory.get() + SLAB_INDICES_OFFSET);
+    for (size_t k = 0; k < PAGE_SLOTS; ++k) {
+        for (size_t i = 0; i < INDEX_COUNT; ++i) {
+            indices[k * INDEX_COUNT + i] = static_cast<unsigned short>(grid[i] + k * VERTEX_COUNT);
+        }
+    }
+    b.indices = rlLoadVertexBufferElement(indices.get(), static_cast<int>(PAGE_SLOTS * INDEX_COUNT * sizeof(unsigned short)), false);
+
+    for (int32_t page = 0; page < PAGE_COUNT; ++page) {
+        const unsigned int vao = rlLoadVertexArray();
+        if (vao == 0) {
+            break;
+        }
+        b.vaos[static_cast<size_t>(page)] = vao;
+        rlEnableVertexArray(vao);
+        bind_page_attributes(page);
+        rlDisableVertexArray();
+    }
+
+    Image atlas = GenImageColor(ATLAS_SIZE, ATLAS_SIZE, {128, 128, 255, 255});
+    b.normal_atlas = LoadTextureFromImage(atlas);
+    UnloadImage(atlas);
+    SetTextureWrap(b.normal_atlas, TEXTURE_WRAP_CLAMP);
+    b.positions_staging = std::make_unique<float[]>(VERTEX_COUNT * 3);
+}
+
+void unload_chunk_buffers() {
+    ChunkBuffers &b = internal_state.buffers;
+    for (const unsigned int vao : b.vaos) {
+        if (vao != 0) {
+            rlUnloadVertexArray(vao);
+        }
+    }
+    rlUnloadVertexBuffer(b.positions);
+    rlUnloadVertexBuffer(b.texcoords);
+    rlUnloadVertexBuffer(b.colors);
+    rlUnloadVertexBuffer(b.indices);
+    UnloadTexture(b.normal_atlas);
+    b = {};
+}
+
+// copies a chunk into its slab's slot: positions move to world space, normals are packed into the
+// slot's atlas tile ([-1, 1] onto [0, 255])
+void upload_chunk(const TerrainChunk &chunk) {
+    static_assert(NORMAL_MAP_SIZE == GRID_SIZE, "texels are taken straight from the vertex normals");
+    ChunkBuffers &b = internal_state.buffers;
+    const Mesh &mesh = chunk.mesh;
+    const float offset_x = static_cast<float>(chunk.cx) * CHUNK_SIZE;
+    const float offset_z = static_cast<float>(chunk.cz) * CHUNK_SIZE;
+    float *positions = b.positions_staging.get();
+    unsigned char *normals = b.normal_map_staging.data();
+    for (size_t i = 0; i < VERTEX_COUNT; ++i) {
+        positions[i * 3] = mesh.vertices[i * 3] + offset_x;
+        positions[i * 3 + 1] = mesh.vertices[i * 3 + 1];
+        positions[i * 3 + 2] = mesh.vertices[i * 3 + 2] + offset_z;
+        for (size_t c = 0; c < 3; ++c) {
+            normals[i * 4 + c] = static_cast<unsigned char>(std::lround((mesh.normals[i * 3 + c] * 0.5f + 0.5f) * 255.0f));
+        }
+        normals[i * 4 + 3] = 255;
+    }
+
+    const auto slot = static_cast<size_t>(chunk.slab);
+    rlUpdateVertexBuffer(b.positions, positions, static_cast<int>(VERTEX_COUNT * 3 * sizeof(float)), static_cast<int>(slot * VERTEX_COUNT * 3 * sizeof(float)));
+    rlUpdateVertexBuffer(b.colors, mesh.colors, static_cast<int>(VERTEX_COUNT * 4), static_cast<int>(slot * VERTEX_COUNT * 4));
+    const Rectangle tile = {static_cast<float>((chunk.slab % ATLAS_TILES) * NORMAL_MAP_SIZE), static_cast<float>((chunk.slab / ATLAS_TILES) * NORMAL_MAP_SIZE), NORMAL_MAP_SIZE, NORMAL_MAP_SIZE};
+    UpdateTextureRec(b.normal_atlas, tile, normals);
+}
+
 void ensure_initialized() {
     if (internal_state.initialized) {
         return;
     }
     internal_state.initialized = true;
 
-    Image img = GenImageColor(2, 2, WHITE);
-    internal_state.texture = LoadTextureFromImage(img);
-    UnloadImage(img);
+    // streaming never touches the heap: all chunk cpu buffers live in one block allocated up front
+    SlabPool &pool = internal_state.pool;
+    pool.memory = std::make_unique<std::byte[]>(SLAB_SIZE * SLAB_COUNT);
+    pool.pyramids = std::make_unique<HeightPyramid[]>(SLAB_COUNT);
+    std::iota(pool.free_slabs.begin(), pool.free_slabs.end(), 0);
+    pool.free_count = SLAB_COUNT;
+
+    // the grid topology is identical for every chunk, so indices are written once per slab (texcoords stay zero)
+    for (int32_t slab = 0; slab < SLAB_COUNT; ++slab) {
+        auto *indices = reinterpret_cast<unsigned short *>(pool.memory.get() + static_cast<size_t>(slab) * SLAB_SIZE + SLAB_INDICES_OFFSET);
+        constexpr int INDEX_GRID = GRID_SIZE - 1;
+        for (int z = 0; z < INDEX_GRID; ++z) {
+            for (int x = 0; x < INDEX_GRID; ++x) {
+                const int i = z * INDEX_GRID + x;
+                const auto tl = static_cast<unsigned short>(z * GRID_SIZE + x);
+                const auto bl = static_cast<unsigned short>((z + 1) * GRID_SIZE + x);
+                const int idx = i * 6;
+                indices[idx] = tl;
+                indices[idx + 1] = bl;
+                indices[idx + 2] = tl + 1;
+                indices[idx + 3] = tl + 1;
+                indices[idx + 4] = bl;
+                indices[idx + 5] = bl + 1;
+            }
+        }
+    }
+
+    if (IsWindowReady()) {
+        Image img = GenImageColor(2, 2, WHITE);
+        internal_state.texture = LoadTextureFromImage(img);
+        UnloadImage(img);
+        internal_state.shader = LoadShaderFromMemory(TERRAIN_VS, TERRAIN_FS);
+        Shader &shader = internal_state.shader;
+        SetShaderValue(shader, GetShaderLocation(shader, "lightDirection"), &LIGHT_DIRECTION, SHADER_UNIFORM_VEC3);
+        // samplers never change units, so they are assigned once instead of on every bind
+        const int32_t diffuse_unit = 0;
+        const int32_t normal_unit = 1;
+        SetShaderValue(shader, shader.locs[SHADER_LOC_MAP_DIFFUSE], &diffuse_unit, SHADER_UNIFORM_INT);
+        SetShaderValue(shader, shader.locs[SHADER_LOC_MAP_NORMAL], &normal_unit, SHADER_UNIFORM_INT);
+        load_chunk_buffers();
+    }
     internal_state.chunk_size = CHUNK_SIZE;
 
     // compute road start position
@@ -56,6 +344,32 @@ void ensure_initialized() {
     internal_state.start_heading = std::atan2(look_ahead_x - start_x, 1.0f);
 }
 
+int32_t acquire_slab() {
+    SlabPool &pool = internal_state.pool;
+    assert(pool.free_count > 0 && "slab pool exhausted");
+    return pool.free_slabs[static_cast<size_t>(--pool.free_count)];
+}
+
+Mesh get_slab_mesh(int32_t slab) {
+    std::byte *base = internal_state.pool.memory.get() + static_cast<size_t>(slab) * SLAB_SIZE;
+    Mesh mesh = {};
+    mesh.vertexCount = GRID_SIZE * GRID_SIZE;
+    mesh.triangleCount = (GRID_SIZE - 1) * (GRID_SIZE - 1) * 2;
+    mesh.vertices = reinterpret_cast<float *>(base);
+    mesh.normals = reinterpret_cast<float *>(base + SLAB_NORMALS_OFFSET);
+    mesh.texcoords = reinterpret_cast<float *>(base + SLAB_TEXCOORDS_OFFSET);
+    mesh.colors = reinterpret_cast<unsigned char *>(base + SLAB_COLORS_OFFSET);
+    mesh.indices = reinterpret_cast<unsigned short *>(base + SLAB_INDICES_OFFSET);
+    return mesh;
+}
+
+void unload_chunk(const TerrainChunk &chunk) {
+    // the slab's gpu slot is simply left stale until the slab is handed out again
+    SlabPool &pool = internal_state.pool;
+    assert(pool.free_count < SLAB_COUNT);
+    pool.free_slabs[static_cast<size_t>(pool.free_count++)] = chunk.slab;
+}
+
 float sample_perlin_noise(float x, float y, float z) {
     const auto get_permutation = []() {
         std::array<int32_t, 512> p;
@@ -103,43 +417,35 @@ float sample_perlin_noise(float x, float y, float z) {
 
 float get_road_center_x(float z) { return sample_perlin_noise(0.0f, 42.0f, z * ROAD_NOISE_SCALE) * ROAD_AMPLITUDE; }
 
-Mesh generate_chunk_mesh(float offset_x, float offset_z) {
-    const auto get_normal = [](float x, float z) {
-        const auto h = [](float x, float z) { return sample_perlin_noise(x * NOISE_SCALE, 0.0f, z * NOISE_SCALE) * TERRAIN_HEIGHT_SCALE; };
-        const float step = 0.1f;
-        const float height = h(x, z);
-        const Vector3 v1 = {step, h(x + step, z) - height, 0.0f};
-        const Vector3 v2 = {0.0f, h(x, z + step) - height, step};
-        return Vector3Normalize(Vector3CrossProduct(v2, v1));
-    };
-    const auto get_color = [&](int x, int z, float wx, float wz) {
-        const float dist = std::abs(wx - get_road_center_x(wz));
-        Color col = ((x + z) % 2 == 0) ? DARKGREEN : GREEN; // green area
-        constexpr Color ROAD_COLOR = {30, 30, 30, 255};     // dark asphalt
-        if (dist < 6.0f) {
-            col = (dist < 4.0f) ? ROAD_COLOR : ColorLerp(ROAD_COLOR, col, (dist - 4.0f) / 2.0f);
-        }
-        return col;
-    };
+float sample_height(float x, float z) { return sample_perlin_noise(x * NOISE_SCALE, 0.0f, z * NOISE_SCALE) * TERRAIN_HEIGHT_SCALE; }
 
-    Mesh mesh = {};
-    mesh.vertexCount = GRID_SIZE * GRID_SIZE;
-    mesh.triangleCount = (GRID_SIZE - 1) * (GRID_SIZE - 1) * 2;
+Terrain::SurfaceSample sample_surface(float x, float z, bool checker) {
+    const float step = 0.1f;
+    const float height = sample_height(x, z);
+    const Vector3 v1 = {step, sample_height(x + step, z) - height, 0.0f};
+    const Vector3 v2 = {0.0f, sample_height(x, z + step) - height, step};
 
-    mesh.vertices = static_cast<float *>(MemAlloc(static_cast<unsigned int>(static_cast<size_t>(mesh.vertexCount) * 3 * sizeof(float))));
-    mesh.normals = static_cast<float *>(MemAlloc(static_cast<unsigned int>(static_cast<size_t>(mesh.vertexCount) * 3 * sizeof(float))));
-    mesh.texcoords = static_cast<float *>(MemAlloc(static_cast<unsigned int>(static_cast<size_t>(mesh.vertexCount) * 2 * sizeof(float))));
-    mesh.colors = static_cast<unsigned char *>(MemAlloc(static_cast<unsigned int>(static_cast<size_t>(mesh.vertexCount) * 4 * sizeof(unsigned char))));
-    mesh.indices = static_cast<unsigned short *>(MemAlloc(static_cast<unsigned int>(static_cast<size_t>(mesh.triangleCount) * 3 * sizeof(unsigned short))));
+    const float dist = std::abs(x - get_road_center_x(z));
+    Color col = checker ? GREEN : DARKGREEN;        // green area
+    constexpr Color ROAD_COLOR = {30, 30, 30, 255}; // dark asphalt
+    if (dist < 6.0f) {
+        col = (dist < 4.0f) ? ROAD_COLOR : ColorLerp(ROAD_COLOR, col, (dist - 4.0f) / 2.0f);
+    }
+    return {.height = height, .normal = Vector3Normalize(Vector3CrossProduct(v2, v1)), .color = col};
+}
 
+void fill_chunk_mesh(const Mesh &mesh, float offset_x, float offset_z) {
+    // writes vertices, normals and colors through the mesh pointers; touches no shared state, so chunks can be filled in parallel
     for (int z = 0; z < GRID_SIZE; ++z) {
         for (int x = 0; x < GRID_SIZE; ++x) {
             const int i = z * GRID_SIZE + x;
             const float wx = offset_x + static_cast<float>(x) * TILE_SIZE;
             const float wz = offset_z + static_cast<float>(z) * TILE_SIZE;
-            const float wy = Terrain::get_height(wx, wz);
-            const Vector3 n = get_normal(wx, wz);
-            const Color col = get_color(x, z, wx, wz);
+            // meshes stay exact even when get_height reads the lossy cache
+            const Terrain::SurfaceSample sample = sample_surface(wx, wz, (x + z) % 2 != 0);
+            const float wy = sample.height;
+            const Vector3 n = sample.normal;
+            const Color col = sample.color;
 
             mesh.vertices[i * 3] = static_cast<float>(x) * TILE_SIZE;
             mesh.vertices[i * 3 + 1] = wy;
@@ -149,32 +455,199 @@ Mesh generate_chunk_mesh(float offset_x, float offset_z) {
             mesh.normals[i * 3 + 1] = n.y;
             mesh.normals[i * 3 + 2] = n.z;
 
-            mesh.texcoords[i * 2] = 0.0f;
-            mesh.texcoords[i * 2 + 1] = 0.0f;
-
             mesh.colors[i * 4] = col.r;
             mesh.colors[i * 4 + 1] = col.g;
             mesh.colors[i * 4 + 2] = col.b;
             mesh.colors[i * 4 + 3] = col.a;
         }
     }
+}
 
-    constexpr int INDEX_GRID = GRID_SIZE - 1;
-    for (int z = 0; z < INDEX_GRID; ++z) {
-        for (int x = 0; x < INDEX_GRID; ++x) {
-            const int i = z * INDEX_GRID + x;
-            const auto tl = static_cast<unsigned short>(z * GRID_SIZE + x);
-            const auto bl = static_cast<unsigned short>((z + 1) * GRID_SIZE + x);
-            const int idx = i * 6;
-            mesh.indices[idx] = tl;
-            mesh.indices[idx + 1] = bl;
-            mesh.indices[idx + 2] = tl + 1;
-            mesh.indices[idx + 3] = tl + 1;
-            mesh.indices[idx + 4] = bl;
-            mesh.indices[idx + 5] = bl + 1;
+// base cells bound their quad's four corners, every level above bounds its four children
+void build_pyramid(HeightPyramid &pyramid, const Mesh &mesh) {
+    const auto height = [&](int32_t x, int32_t z) { return mesh.vertices[static_cast<size_t>(z * GRID_SIZE + x) * 3 + 1]; };
+    for (int32_t j = 0; j < PYRAMID_BASE; ++j) {
+        for (int32_t i = 0; i < PYRAMID_BASE; ++i) {
+            const auto n = static_cast<size_t>(j * PYRAMID_BASE + i);
+            if (i >= GRID_SIZE - 1 || j >= GRID_SIZE - 1) {
+                pyramid.min[n] = INFINITY;
+                pyramid.max[n] = -INFINITY;
+                continue;
+            }
+            const std::initializer_list<float> corners = {height(i, j), height(i + 1, j), height(i, j + 1), height(i + 1, j + 1)};
+            pyramid.min[n] = std::min(corners);
+            pyramid.max[n] = std::max(corners);
+        }
+    }
+    for (int32_t level = 1; level < PYRAMID_LEVELS; ++level) {
+        const int32_t dim = PYRAMID_BASE >> level;
+        const size_t base = pyramid_offset(level);
+        const size_t child_base = pyramid_offset(level - 1);
+        for (int32_t j = 0; j < dim; ++j) {
+            for (int32_t i = 0; i < dim; ++i) {
+                const auto child = [&](int32_t di, int32_t dj) { return child_base + static_cast<size_t>((2 * j + dj) * dim * 2 + 2 * i + di); };
+                const size_t n = base + static_cast<size_t>(j * dim + i);
+                pyramid.min[n] = std::min({pyramid.min[child(0, 0)], pyramid.min[child(1, 0)], pyramid.min[child(0, 1)], pyramid.min[child(1, 1)]});
+                pyramid.max[n] = std::max({pyramid.max[child(0, 0)], pyramid.max[child(1, 0)], pyramid.max[child(0, 1)], pyramid.max[child(1, 1)]});
+            }
         }
     }
-    return mesh;
+}
+
+struct Interval {
+    float enter;
+    float exit;
+};
+
+// slab test of a ray against an axis-aligned box, clipped to [t_min, t_max]; empty when enter > exit
+Interval clip_box(Vector3 origin, Vector3 dir, Vector3 lo, Vector3 hi, float t_min, float t_max) {
+    Interval interval = {t_min, t_max};
+    if (lo.y > hi.y) {
+        return {INFINITY, -INFINITY};
+    }
+    const auto axis = [&](float o, float d, float a, float b) {
+        if (d == 0.0f) {
+            if (o < a || o > b) {
+                interval = {INFINITY, -INFINITY};
+            }
+            return;
+        }
+        const float t0 = (a - o) / d;
+        const float t1 = (b - o) / d;
+        interval.enter = std::max(interval.enter, std::min(t0, t1));
+        interval.exit = std::min(interval.exit, std::max(t0, t1));
+    };
+    axis(origin.x, dir.x, lo.x, hi.x);
+    axis(origin.y, dir.y, lo.y, hi.y);
+    axis(origin.z, dir.z, lo.z, hi.z);
+    return interval;
+}
+
+// moller-trumbore, two-sided
+std::optional<float> intersect_triangle(Vector3 origin, Vector3 dir, Vector3 a, Vector3 b, Vector3 c) {
+    const Vector3 e1 = Vector3Subtract(b, a);
+    const Vector3 e2 = Vector3Subtract(c, a);
+    const Vector3 p = Vector3CrossProduct(dir, e2);
+    const float det = Vector3DotProduct(e1, p);
+    if (std::abs(det) < 1e-9f) {
+        return std::nullopt;
+    }
+    const float inv_det = 1.0f / det;
+    const Vector3 s = Vector3Subtract(origin, a);
+    const float u = Vector3DotProduct(s, p) * inv_det;
+    if (u < 0.0f || u > 1.0f) {
+        return std::nullopt;
+    }
+    const Vector3 q = Vector3CrossProduct(s, e1);
+    const float v = Vector3DotProduct(dir, q) * inv_det;
+    if (v < 0.0f || u + v > 1.0f) {
+        return std::nullopt;
+    }
+    return Vector3DotProduct(e2, q) * inv_det;
+}
+
+struct SegmentHit {
+    float t;
+    Vector3 normal;
+};
+
+// descends the pyramid front to back, skipping every node the ray passes above or below; nodes entered
+// after the best hit so far are pruned, so the walk ends as soon as nothing nearer remains
+std::optional<SegmentHit> raycast_chunk(const TerrainChunk &chunk, Vector3 origin, Vector3 dir, float t_enter, float t_exit) {
+    const HeightPyramid &pyramid = internal_state.pool.pyramids[static_cast<size_t>(chunk.slab)];
+    const Vector3 local = {origin.x - static_cast<float>(chunk.cx) * CHUNK_SIZE, origin.y, origin.z - static_cast<float>(chunk.cz) * CHUNK_SIZE};
+    const auto vertex = [&](int32_t x, int32_t z) {
+        const float *v = &chunk.mesh.vertices[static_cast<size_t>(z * GRID_SIZE + x) * 3];
+        return Vector3{v[0], v[1], v[2]};
+    };
+
+    struct Node {
+        int32_t level;
+        int32_t i;
+        int32_t j;
+        float enter;
+    };
+    const auto clip_node = [&](int32_t level, int32_t i, int32_t j, float t_max) {
+        const size_t n = pyramid_offset(level) + static_cast<size_t>(j * (PYRAMID_BASE >> level) + i);
+        const auto edge = [&](int32_t cell) { return static_cast<float>(std::min(cell << level, GRID_SIZE - 1)) * TILE_SIZE; };
+        const Vector3 lo = {edge(i), pyramid.min[n], edge(j)};
+        const Vector3 hi = {edge(i + 1), pyramid.max[n], edge(j + 1)};
+        return clip_box(local, dir, lo, hi, t_enter, t_max);
+    };
+
+    std::optional<SegmentHit> best;
+    float best_t = t_exit;
+    std::array<Node, 4 * PYRAMID_LEVELS> stack;
+    size_t top = 0;
+    if (const Interval root = clip_node(PYRAMID_LEVELS - 1, 0, 0, best_t); root.enter <= root.exit) {
+        stack[top++] = {PYRAMID_LEVELS - 1, 0, 0, root.enter};
+    }
+    while (top > 0) {
+        const Node node = stack[--top];
+        if (node.enter > best_t) {
+            continue;
+        }
+        if (node.level == 0) {
+            const Vector3 tl = vertex(node.i, node.j);
+            const Vector3 tr = vertex(node.i + 1, node.j);
+            const Vector3 bl = vertex(node.i, node.j + 1);
+            const Vector3 br = vertex(node.i + 1, node.j + 1);
+            for (const auto &[a, b, c] : {std::array{tl, bl, tr}, std::array{tr, bl, br}}) {
+                const std::optional<float> t = intersect_triangle(local, dir, a, b, c);
+                if (t && *t >= t_enter && *t <= best_t) {
+                    best_t = *t;
+                    best = SegmentHit{.t = *t, .normal = Vector3Normalize(Vector3CrossProduct(Vector3Subtract(b, a), Vector3Subtract(c, a)))};
+                }
+            }
+            continue;
+        }
+        // push the hit children farthest first so the nearest is popped next
+        const size_t first = top;
+        for (int32_t k = 0; k < 4; ++k) {
+            const int32_t i = node.i * 2 + (k & 1);
+            const int32_t j = node.j * 2 + (k >> 1);
+            const Interval clip = clip_node(node.level - 1, i, j, best_t);
+            if (clip.enter > clip.exit) {
+                continue;
+            }
+            size_t slot = top++;
+            for (; slot > first && stack[slot - 1].enter < clip.enter; --slot) {
+                stack[slot] = stack[slot - 1];
+            }
+            stack[slot] = {node.level - 1, i, j, clip.enter};
+        }
+    }
+    return best;
+}
+
+// where no pyramid exists: samples get_height a tile apart horizontally and bisects the first crossing
+std::optional<SegmentHit> raycast_heights(Vector3 origin, Vector3 dir, float t_enter, float t_exit) {
+    const auto clearance = [&](float t) {
+        const Vector3 p = Vector3Add(origin, Vector3Scale(dir, t));
+        return p.y - Terrain::get_height(p.x, p.z);
+    };
+    const auto hit_at = [&](float t) {
+        const Vector3 p = Vector3Add(origin, Vector3Scale(dir, t));
+        return SegmentHit{.t = t, .normal = sample_surface(p.x, p.z, false).normal};
+    };
+    const float step = TILE_SIZE / std::max(std::sqrt(dir.x * dir.x + dir.z * dir.z), 1e-6f);
+    float t0 = t_enter;
+    if (clearance(t0) <= 0.0f) {
+        return hit_at(t0);
+    }
+    const auto max_steps = static_cast<int32_t>(std::ceil((t_exit - t_enter) / step)) + 1;
+    for (int32_t n = 0; n < max_steps && t0 < t_exit; ++n) {
+        float t1 = std::min(t0 + step, t_exit);
+        if (clearance(t1) <= 0.0f) {
+            for (int32_t i = 0; i < 16; ++i) {
+                const float mid = (t0 + t1) * 0.5f;
+                (clearance(mid) <= 0.0f ? t1 : t0) = mid;
+            }
+            return hit_at(t1);
+        }
+        t0 = t1;
+    }
+    return std::nullopt;
 }
 
 } // namespace
@@ -182,48 +655,363 @@ Mesh generate_chunk_mesh(float offset_x, float offset_z) {
 namespace Terrain {
 
 void update(const Vector3 &car_pos) {
+    const Focus focus = {.position = car_pos, .priority = 0};
+    update(std::span(&focus, 1));
+}
+
+void update(std::span<const Focus> foci) {
     ensure_initialized();
-    const int cx = (int)std::floor(car_pos.x / CHUNK_SIZE);
-    const int cz = (int)std::floor(car_pos.z / CHUNK_SIZE);
+    assert(!foci.empty() && foci.size() <= MAX_FOCI);
+    if (internal_state.representation != Representation::CHUNKS) {
+        // a ring has a single center, so it follows the most important focus
+        HeightRing::update(std::ranges::max(foci, {}, &Focus::priority).position);
+        return;
+    }
 
-    // unload distant chunks
+    // the union of every focus' window. each chunk is ranked by the most important, closest focus that wants
+    // it, so overlapping windows collapse onto one entry and the cap drops the least important chunks first
+    struct Wanted {
+        int32_t cx;
+        int32_t cz;
+        int32_t priority;
+        int32_t distance;
+    };
+    std::array<Wanted, MAX_FOCI * WINDOW_CHUNKS> wanted;
+    size_t wanted_count = 0;
+    for (const Focus &focus : foci) {
+        const int32_t cx = static_cast<int32_t>(std::floor(focus.position.x / CHUNK_SIZE));
+        const int32_t cz = static_cast<int32_t>(std::floor(focus.position.z / CHUNK_SIZE));
+        for (int32_t z = -CHUNK_RADIUS; z <= CHUNK_RADIUS; ++z) {
+            for (int32_t x = -CHUNK_RADIUS; x <= CHUNK_RADIUS; ++x) {
+                wanted[wanted_count++] = {cx + x, cz + z, focus.priority, std::max(std::abs(x), std::abs(z))};
+            }
+        }
+    }
+    // ties are broken by position, so a cap falling between equal ranks keeps the same chunks every frame
+    std::sort(wanted.begin(), wanted.begin() + static_cast<std::ptrdiff_t>(wanted_count), [](const Wanted &a, const Wanted &b) {
+        return std::tie(b.priority, a.distance, a.cz, a.cx) < std::tie(a.priority, b.distance, b.cz, b.cx);
+    });
+    const size_t limit = std::min(static_cast<size_t>(SLAB_COUNT), internal_state.memory_cap / CHUNK_BYTES);
+    std::array<Wanted, SLAB_COUNT> selected;
+    size_t selected_count = 0;
+    for (size_t i = 0; i < wanted_count && selected_count < limit; ++i) {
+        const Wanted &w = wanted[i];
+        if (std::none_of(selected.begin(), selected.begin() + static_cast<std::ptrdiff_t>(selected_count), [&](const Wanted &k) { return k.cx == w.cx && k.cz == w.cz; })) {
+            selected[selected_count++] = w;
+        }
+    }
+    const auto kept = std::span(selected.data(), selected_count);
+    const auto is_kept = [&](int32_t cx, int32_t cz) { return std::ranges::any_of(kept, [&](const Wanted &k) { return k.cx == cx && k.cz == cz; }); };
+
+    // unload chunks no focus wants any more
     std::erase_if(internal_state.chunks, [&](const TerrainChunk &c) {
-        bool keep = std::abs(c.cx - cx) <= 2 && std::abs(c.cz - cz) <= 2;
+        bool keep = is_kept(c.cx, c.cz);
         if (!keep)
-            UnloadModel(c.model);
+            unload_chunk(c);
+        else
+            HeightCache::touch(c.cx, c.cz);
         return !keep;
     });
 
-    // load new chunks
-    for (int z = -2; z <= 2; ++z) {
-        for (int x = -2; x <= 2; ++x) {
-            if (std::none_of(internal_state.chunks.begin(), internal_state.chunks.end(), [&](const auto &c) { return c.cx == cx + x && c.cz == cz + z; })) {
-                Mesh mesh = generate_chunk_mesh(static_cast<float>(cx + x) * CHUNK_SIZE, static_cast<float>(cz + z) * CHUNK_SIZE);
-                UploadMesh(&mesh, false);
-                Model model = LoadModelFromMesh(mesh);
-                model.materials[0].maps[MATERIAL_MAP_DIFFUSE].texture = internal_state.texture;
-                internal_state.chunks.push_back({cx + x, cz + z, model});
-            }
+    // load new chunks: slabs are taken serially, the noise-heavy fill runs across cores
+    std::array<TerrainChunk, SLAB_COUNT> pending = {};
+    int32_t pending_count = 0;
+    for (const Wanted &w : kept) {
+        if (std::none_of(internal_state.chunks.begin(), internal_state.chunks.end(), [&](const auto &c) { return c.cx == w.cx && c.cz == w.cz; })) {
+            const int32_t slab = acquire_slab();
+            pending[static_cast<size_t>(pending_count++)] = {w.cx, w.cz, slab, get_slab_mesh(slab)};
         }
     }
+
+    // chunks inside a baked atlas point straight into the mapped tile instead of evaluating noise.
+    // the mapping is read-only; raylib's `Mesh` has no const variant but only reads these arrays.
+    std::array<int32_t, SLAB_COUNT> procedural = {};
+    int32_t procedural_count = 0;
+    for (int32_t i = 0; i < pending_count; ++i) {
+        TerrainChunk &c = pending[static_cast<size_t>(i)];
+        const std::optional<Atlas::Tile> tile = Atlas::find_tile(c.cx, c.cz);
+        if (!tile) {
+            procedural[static_cast<size_t>(procedural_count++)] = i;
+            continue;
+        }
+        c.mesh.vertices = const_cast<float *>(tile->vertices);
+        c.mesh.normals = const_cast<float *>(tile->normals);
+        c.mesh.colors = const_cast<unsigned char *>(tile->colors);
+    }
+    Jobs::parallel_for(procedural_count, [&](int32_t i) {
+        const TerrainChunk &c = pending[static_cast<size_t>(procedural[static_cast<size_t>(i)])];
+        fill_chunk_mesh(c.mesh, static_cast<float>(c.cx) * CHUNK_SIZE, static_cast<float>(c.cz) * CHUNK_SIZE);
+    });
+    Jobs::parallel_for(pending_count, [&](int32_t i) {
+        const TerrainChunk &c = pending[static_cast<size_t>(i)];
+        build_pyramid(internal_state.pool.pyramids[static_cast<size_t>(c.slab)], c.mesh);
+    });
+
+    // gpu uploads and cache inserts stay on the main thread
+    for (int32_t i = 0; i < pending_count; ++i) {
+        TerrainChunk &c = pending[static_cast<size_t>(i)];
+        HeightCache::store(c.cx, c.cz, c.mesh.vertices);
+        // headless runs (tests, benchmarks) only keep the cpu side
+        if (IsWindowReady()) {
+            upload_chunk(c);
+        }
+        internal_state.chunks.push_back(c);
+    }
 }
 
-void draw() {
+void draw(const Camera3D &camera) {
     ensure_initialized();
-    for (const auto &chunk : internal_state.chunks) {
-        DrawModel(chunk.model, {(float)chunk.cx * CHUNK_SIZE, 0.0f, (float)chunk.cz * CHUNK_SIZE}, 1.0f, WHITE);
+    HeightRing::draw();
+    auto &s = internal_state;
+    s.draw_stats = {};
+    if (s.chunks.empty() || s.buffers.positions == 0) {
+        return;
     }
+
+    // every chunk shares the shader, both textures and the view-projection, so those are bound once;
+    // each page then draws its resident slots in as few contiguous index ranges as possible
+    DrawStats &stats = s.draw_stats;
+    const Matrix mvp = MatrixMultiply(MatrixMultiply(rlGetMatrixTransform(), rlGetMatrixModelview()), rlGetMatrixProjection());
+    const Vector4 diffuse = {1.0f, 1.0f, 1.0f, 1.0f};
+    Fog::apply(s.shader);
+    rlEnableShader(s.shader.id);
+    rlSetUniformMatrix(s.shader.locs[SHADER_LOC_MATRIX_MVP], mvp);
+    rlSetUniform(s.shader.locs[SHADER_LOC_COLOR_DIFFUSE], &diffuse, SHADER_UNIFORM_VEC4, 1);
+    rlActiveTextureSlot(0);
+    rlEnableTexture(s.texture.id);
+    rlActiveTextureSlot(1);
+    rlEnableTexture(s.buffers.normal_atlas.id);
+    stats.shader_binds = 1;
+    stats.uniform_updates = 5; // mvp, diffuse and the three fog uniforms
+    stats.texture_binds = 2;
+
+    // chunks outside this view are left out of the runs; the pyramid's root bounds each chunk's heights
+    const Frustum::Volume view = Frustum::from_camera(camera, Frustum::get_current_aspect());
+    std::array<bool, SLAB_COUNT> resident = {};
+    for (const TerrainChunk &chunk : s.chunks) {
+        const size_t root = pyramid_offset(PYRAMID_LEVELS - 1);
+        const HeightPyramid &pyramid = s.pool.pyramids[static_cast<size_t>(chunk.slab)];
+        const float half_height = (pyramid.max[root] - pyramid.min[root]) * 0.5f;
+        const Vector3 center = {(static_cast<float>(chunk.cx) + 0.5f) * CHUNK_SIZE, pyramid.min[root] + half_height, (static_cast<float>(chunk.cz) + 0.5f) * CHUNK_SIZE};
+        const float radius = std::sqrt(CHUNK_SIZE * CHUNK_SIZE * 0.5f + half_height * half_height);
+        if (Frustum::intersects_sphere(view, center, radius)) {
+            resident[static_cast<size_t>(chunk.slab)] = true;
+        } else {
+            ++stats.culled_chunks;
+        }
+    }
+    for (int32_t page = 0; page < PAGE_COUNT; ++page) {
+        const int32_t first = page * PAGE_SLOTS;
+        const int32_t last = std::min(first + PAGE_SLOTS, SLAB_COUNT);
+        bool bound = false;
+        for (int32_t slot = first; slot < last;) {
+            if (!resident[static_cast<size_t>(slot)]) {
+                ++slot;
+                continue;
+            }
+            const int32_t run_start = slot;
+            while (slot < last && resident[static_cast<size_t>(slot)]) {
+                ++slot;
+            }
+            if (!bound) {
+                bind_page(page);
+                bound = true;
+            }
+            rlDrawVertexArrayElements((run_start - first) * static_cast<int32_t>(INDEX_COUNT), (slot - run_start) * static_cast<int32_t>(INDEX_COUNT), nullptr);
+            ++stats.draw_calls;
+        }
+    }
+
+    rlDisableVertexArray();
+    rlDisableVertexBuffer();
+    rlDisableVertexBufferElement();
+    rlDisableTexture();
+    rlActiveTextureSlot(0);
+    rlDisableTexture();
+    rlDisableShader();
 }
 
 void cleanup() {
     for (const auto &chunk : internal_state.chunks) {
-        UnloadModel(chunk.model);
+        unload_chunk(chunk);
     }
     internal_state.chunks.clear();
-    UnloadTexture(internal_state.texture);
+    HeightRing::cleanup();
+    internal_state.pool = {};
+    // cleanup may run again before anything is reloaded (e.g. switching representations)
+    if (internal_state.initialized && IsWindowReady()) {
+        UnloadTexture(internal_state.texture);
+        UnloadShader(internal_state.shader);
+        unload_chunk_buffers();
+    }
+    internal_state.texture = {};
+    internal_state.shader = {};
+    internal_state.initialized = false;
+}
+
+void set_representation(Representation representation) {
+    cleanup();
+    internal_state.representation = representation;
+    HeightRing::set_level_count(representation == Representation::CLIPMAP ? CLIPMAP_LEVELS : 1);
 }
 
-float get_height(float x, float z) { return sample_perlin_noise(x * NOISE_SCALE, 0.0f, z * NOISE_SCALE) * TERRAIN_HEIGHT_SCALE; }
+void save(Snapshot::Writer &writer) {
+    const auto &chunks = internal_state.chunks;
+    writer.write(static_cast<uint32_t>(chunks.size()));
+    const auto record = std::make_unique<ChunkRecord>();
+    for (const TerrainChunk &c : chunks) {
+        record->cx = c.cx;
+        record->cz = c.cz;
+        for (size_t i = 0; i < VERTEX_COUNT; ++i) {
+            record->heights[i] = c.mesh.vertices[i * 3 + 1];
+            for (size_t k = 0; k < 3; ++k) {
+                record->normals[i * 3 + k] = static_cast<int8_t>(std::lround(c.mesh.normals[i * 3 + k] * 127.0f));
+                record->colors[i * 3 + k] = c.mesh.colors[i * 4 + k];
+            }
+        }
+        writer.write(*record);
+    }
+}
+
+Snapshot::Restore load(Snapshot::Reader &reader) {
+    uint32_t count = 0;
+    if (!reader.read(count) || count > SLAB_COUNT || !reader.skip(count * sizeof(ChunkRecord))) {
+        return {};
+    }
+    const std::span<const std::byte> section = reader.bytes.subspan(reader.offset - count * sizeof(ChunkRecord), count * sizeof(ChunkRecord));
+    // a ring has nothing to take chunks from; it regenerates around the restored car instead
+    if (internal_state.representation != Representation::CHUNKS) {
+        return [] {};
+    }
+    const auto get_coords = [&](size_t n) {
+        std::array<int32_t, 2> coords = {};
+        static_assert(offsetof(ChunkRecord, cz) == offsetof(ChunkRecord, cx) + sizeof(int32_t));
+        std::memcpy(coords.data(), section.data() + n * sizeof(ChunkRecord) + offsetof(ChunkRecord, cx), sizeof(coords));
+        return coords;
+    };
+    for (size_t n = 0; n < count; ++n) {
+        for (size_t m = 0; m < n; ++m) {
+            if (get_coords(m) == get_coords(n)) {
+                return {};
+            }
+        }
+    }
+
+    return [section, count] {
+        ensure_initialized();
+        for (const TerrainChunk &chunk : internal_state.chunks) {
+            unload_chunk(chunk);
+        }
+        internal_state.chunks.clear();
+
+        // decoding is a copy per vertex, so only the pyramids are built across cores
+        const auto limit = std::min<size_t>({count, SLAB_COUNT, internal_state.memory_cap / CHUNK_BYTES});
+        std::array<TerrainChunk, SLAB_COUNT> restored = {};
+        const auto record = std::make_unique<ChunkRecord>();
+        for (size_t n = 0; n < limit; ++n) {
+            std::memcpy(record.get(), section.data() + n * sizeof(ChunkRecord), sizeof(ChunkRecord));
+            const int32_t slab = acquire_slab();
+            const Mesh mesh = get_slab_mesh(slab);
+            for (int32_t z = 0; z < GRID_SIZE; ++z) {
+                for (int32_t x = 0; x < GRID_SIZE; ++x) {
+                    const auto i = static_cast<size_t>(z * GRID_SIZE + x);
+                    const Vector3 normal = Vector3Normalize({static_cast<float>(record->normals[i * 3]), static_cast<float>(record->normals[i * 3 + 1]), static_cast<float>(record->normals[i * 3 + 2])});
+                    mesh.vertices[i * 3] = static_cast<float>(x) * TILE_SIZE;
+                    mesh.vertices[i * 3 + 1] = record->heights[i];
+                    mesh.vertices[i * 3 + 2] = static_cast<float>(z) * TILE_SIZE;
+                    mesh.normals[i * 3] = normal.x;
+                    mesh.normals[i * 3 + 1] = normal.y;
+                    mesh.normals[i * 3 + 2] = normal.z;
+                    mesh.colors[i * 4] = record->colors[i * 3];
+                    mesh.colors[i * 4 + 1] = record->colors[i * 3 + 1];
+                    mesh.colors[i * 4 + 2] = record->colors[i * 3 + 2];
+                    mesh.colors[i * 4 + 3] = 255;
+                }
+            }
+            restored[n] = {record->cx, record->cz, slab, mesh};
+        }
+        Jobs::parallel_for(static_cast<int32_t>(limit), [&](int32_t i) {
+            const TerrainChunk &c = restored[static_cast<size_t>(i)];
+            build_pyramid(internal_state.pool.pyramids[static_cast<size_t>(c.slab)], c.mesh);
+        });
+        for (size_t n = 0; n < limit; ++n) {
+            const TerrainChunk &c = restored[n];
+            HeightCache::store(c.cx, c.cz, c.mesh.vertices);
+            if (IsWindowReady()) {
+                upload_chunk(c);
+            }
+            internal_state.chunks.push_back(c);
+        }
+    };
+}
+
+float get_height(float x, float z) {
+    // resident terrain answers from memory; anything never streamed in falls back to noise
+    if (const std::optional<float> ring = HeightRing::sample(x, z)) {
+        return *ring;
+    }
+    if (const std::optional<float> cached = HeightCache::sample(x, z)) {
+        return *cached;
+    }
+    return sample_height(x, z);
+}
+
+void get_heights(std::span<const float> xs, std::span<const float> zs, std::span<float> heights) {
+    assert(xs.size() == zs.size() && zs.size() == heights.size());
+    // the same lookups as single queries, so batched callers agree exactly with the player car
+    for (size_t i = 0; i < heights.size(); ++i) {
+        heights[i] = get_height(xs[i], zs[i]);
+    }
+}
+
+std::optional<RayHit> raycast(Vector3 origin, Vector3 dir, float max_dist) {
+    ensure_initialized();
+    assert(std::isfinite(max_dist) && std::isfinite(dir.x) && std::isfinite(dir.y) && std::isfinite(dir.z));
+    // walks the chunk columns the ray crosses in order, so the first column with a hit holds the nearest one
+    int32_t cx = static_cast<int32_t>(std::floor(origin.x / CHUNK_SIZE));
+    int32_t cz = static_cast<int32_t>(std::floor(origin.z / CHUNK_SIZE));
+    const auto first_boundary = [](float o, float d, int32_t cell) {
+        if (d == 0.0f) {
+            return INFINITY;
+        }
+        return (static_cast<float>(d > 0.0f ? cell + 1 : cell) * CHUNK_SIZE - o) / d;
+    };
+    float next_x = first_boundary(origin.x, dir.x, cx);
+    float next_z = first_boundary(origin.z, dir.z, cz);
+    const float delta_x = dir.x == 0.0f ? INFINITY : CHUNK_SIZE / std::abs(dir.x);
+    const float delta_z = dir.z == 0.0f ? INFINITY : CHUNK_SIZE / std::abs(dir.z);
+
+    // one step per chunk boundary the ray's xz extent can cross, plus the start and end columns
+    const auto max_steps = static_cast<int32_t>(std::ceil(max_dist * (std::abs(dir.x) + std::abs(dir.z)) / CHUNK_SIZE)) + 2;
+    float t = 0.0f;
+    for (int32_t step = 0; step < max_steps; ++step) {
+        const float t_exit = std::min({next_x, next_z, max_dist});
+        const auto it = std::ranges::find_if(internal_state.chunks, [&](const TerrainChunk &c) { return c.cx == cx && c.cz == cz; });
+        const std::optional<SegmentHit> hit = it != internal_state.chunks.end() ? raycast_chunk(*it, origin, dir, t, t_exit) : raycast_heights(origin, dir, t, t_exit);
+        if (hit) {
+            return RayHit{.distance = hit->t, .point = Vector3Add(origin, Vector3Scale(dir, hit->t)), .normal = hit->normal};
+        }
+        if (t_exit >= max_dist) {
+            return std::nullopt;
+        }
+        if (next_x < next_z) {
+            cx += dir.x > 0.0f ? 1 : -1;
+            t = next_x;
+            next_x += delta_x;
+        } else {
+            cz += dir.z > 0.0f ? 1 : -1;
+            t = next_z;
+            next_z += delta_z;
+        }
+    }
+    return std::nullopt;
+}
+
+void set_memory_cap(size_t bytes) { internal_state.memory_cap = bytes; }
+
+size_t get_resident_bytes() { return internal_state.chunks.size() * CHUNK_BYTES; }
+
+int32_t get_resident_count() { return static_cast<int32_t>(internal_state.chunks.size()); }
 
 float get_road_center_x(float z) { return ::get_road_center_x(z); }
 
@@ -237,4 +1025,29 @@ float get_start_heading() {
     return internal_state.start_heading;
 }
 
+float get_view_distance() {
+    // the car can sit anywhere in its own chunk, so only the ring of neighbours is guaranteed
+    if (internal_state.representation == Representation::CHUNKS) {
+        return static_cast<float>(CHUNK_RADIUS) * CHUNK_SIZE;
+    }
+    return HeightRing::get_extent() * 0.5f;
+}
+
+Vector3 get_light_direction() { return LIGHT_DIRECTION; }
+
+float get_chunk_size() { return CHUNK_SIZE; }
+
+int32_t get_chunk_resolution() { return GRID_SIZE; }
+
+DrawStats get_draw_stats() { return internal_state.draw_stats; }
+
+SurfaceSample sample_surface(float x, float z, bool checker) { return ::sample_surface(x, z, checker); }
+
+void generate_chunk(const Mesh &mesh, int32_t cx, int32_t cz) { fill_chunk_mesh(mesh, static_cast<float>(cx) * CHUNK_SIZE, static_cast<float>(cz) * CHUNK_SIZE); }
+
+const Mesh *find_chunk_mesh(int32_t cx, int32_t cz) {
+    const auto it = std::ranges::find_if(internal_state.chunks, [&](const TerrainChunk &c) { return c.cx == cx && c.cz == cz; });
+    return it == internal_state.chunks.end() ? nullptr : &it->mesh;
+}
+
 } // namespace Terrain
\ No newline at end of file
@@ -1,26 +1,95 @@
 #pragma once
 
 #include "raylib.h"
+#include "snapshot.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
 #include <vector>
 
 namespace Terrain {
 
+/** how terrain around the car is kept resident */
+enum class Representation {
+    CHUNKS,  // 5x5 window of chunks, regenerated a whole chunk at a time
+    RING,    // toroidal heightfield centered on the car, regenerating only newly exposed rows and columns
+    CLIPMAP, // nested rings of doubling spacing, reaching several kilometers at bounded cost
+};
+
+/** a point streaming keeps terrain resident around; higher priorities keep their chunks when the memory cap is reached */
+struct Focus {
+    Vector3 position;
+    int32_t priority;
+};
+
+/** exact procedural surface at one point */
+struct SurfaceSample {
+    float height;
+    Vector3 normal;
+    Color color;
+};
+
+/** where a ray first meets the terrain surface */
+struct RayHit {
+    float distance; // along the ray, in units of its direction
+    Vector3 point;
+    Vector3 normal; // of the hit triangle, facing up
+};
+
+/** gpu state changes issued by the last `draw` */
+struct DrawStats {
+    int32_t draw_calls;
+    int32_t shader_binds;
+    int32_t texture_binds;
+    int32_t uniform_updates;
+    int32_t culled_chunks; // resident, but outside the view
+};
+
 /** updates the terrain system (chunk generation/unloading) based on car position */
 void update(const Vector3 &car_pos);
 
-/** draws the terrain chunks */
-void draw();
+/** keeps the union of the foci's chunk windows resident (up to 8 foci); chunks wanted by several foci are held once,
+    and past the memory cap the chunks of the lowest priority, then farthest from their focus, are dropped. the ring
+    and clipmap representations follow the highest-priority focus only */
+void update(std::span<const Focus> foci);
+
+/** caps the cpu memory of resident chunks (meshes and height pyramids) below the preallocated pool */
+void set_memory_cap(size_t bytes);
+
+/** draws the terrain chunks inside `camera`'s view */
+void draw(const Camera3D &camera);
 
 /** cleans up terrain resources */
 void cleanup();
 
+/** switches the terrain representation, dropping everything currently resident */
+void set_representation(Representation representation);
+
+/** appends the resident chunks' heightfields (heights, byte-packed normals, colors) to `writer`; the ring and clipmap
+    representations write none and regenerate on their next update */
+void save(Snapshot::Writer &writer);
+
+/** reads the chunks `save` wrote and returns what makes them resident in place of the current ones, without
+    evaluating noise; they stay resident while an update still wants them, and past the memory cap the rest is left to
+    the next update. empty if the data is malformed */
+Snapshot::Restore load(Snapshot::Reader &reader);
+
 //
 // getters
 //
 
-/** returns the calculated terrain elevation (y) at world coordinates (x, z) */
+/** returns the terrain elevation (y) at world coordinates (x, z), read from the ring or the height cache when they cover it */
 float get_height(float x, float z);
 
+/** writes `get_height(xs[i], zs[i])` into `heights[i]` for a batch of points (thread-safe between updates) */
+void get_heights(std::span<const float> xs, std::span<const float> zs, std::span<float> heights);
+
+/** returns the first hit of the ray `origin + t * dir` with the terrain for t in [0, max_dist]. resident chunks are
+    walked through their min/max height pyramids down to the exact triangles; anywhere else falls back to sampling
+    `get_height` a tile apart */
+std::optional<RayHit> raycast(Vector3 origin, Vector3 dir, float max_dist);
+
 /** returns the road center x coordinate at a given z position */
 float get_road_center_x(float z);
 
@@ -30,4 +99,34 @@ Vector3 get_start_position();
 /** returns the starting heading aligned with the road */
 float get_start_heading();
 
+/** returns the distance from the car the current representation is guaranteed to cover in every direction */
+float get_view_distance();
+
+/** returns the cpu memory held by resident chunks */
+size_t get_resident_bytes();
+
+/** returns the number of resident chunks */
+int32_t get_resident_count();
+
+/** returns the unit direction towards the light the terrain is shaded with */
+Vector3 get_light_direction();
+
+/** returns the world-space edge length of a chunk */
+float get_chunk_size();
+
+/** returns the number of vertices along a chunk edge */
+int32_t get_chunk_resolution();
+
+/** evaluates the procedural surface at world (x, z), bypassing every cache (thread-safe); `checker` picks the alternate grass shade */
+SurfaceSample sample_surface(float x, float z, bool checker);
+
+/** returns the gpu state changes issued by the last chunk draw */
+DrawStats get_draw_stats();
+
+/** writes vertices, normals and colors of chunk (cx, cz) into the buffers `mesh` points at (thread-safe) */
+void generate_chunk(const Mesh &mesh, int32_t cx, int32_t cz);
+
+/** returns the cpu mesh of a resident chunk (vertices chunk-local, heights world-space) or nullptr */
+const Mesh *find_chunk_mesh(int32_t cx, int32_t cz);
+
 } // namespace Terrain
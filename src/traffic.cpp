@@ -0,0 +1,287 @@
+#include "traffic.hpp"
+#include "fog.hpp"
+#include "glsl.hpp"
+#include "jobs.hpp"
+#include "raymath.h"
+#include "terrain.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <span>
+
+namespace {
+
+constexpr int32_t MAX_CARS = 4096;
+constexpr int32_t BLOCK = 256;         // cars per job: contiguous runs of every array, long enough to vectorize
+static_assert(MAX_CARS % BLOCK == 0);  // every block owns BLOCK slots, filled or not
+constexpr float LANE_OFFSET = 2.0f;    // lane center from the road center; the asphalt is 4 units to either side
+constexpr float CAR_GAP = 24.0f;       // spacing between cars in a lane
+constexpr float MIN_SPAN = 250.0f;     // half the stretch of road the population covers
+constexpr float LOOKAHEAD = 4.0f;      // headings follow the road between here and this far ahead
+constexpr float SMOOTHING = 0.1f;      // weight of the newest update in the running average
+constexpr std::array<float, 2> LANE_SPEEDS = {14.0f, 12.0f}; // +z, -z; equal within a lane, so cars never catch up
+
+// right-hand traffic: +z drivers see +x on their left, so their lane is on the -x side
+constexpr float get_direction(float lane) { return lane < 0.0f ? 1.0f : -1.0f; }
+
+constexpr const char *INSTANCED_VS = GLSL_VERSION FOG_GLSL R"(
+in_attr vec3 vertexPosition;
+in_attr vec3 vertexNormal;
+in_attr mat4 instanceTransform;
+uniform mat4 mvp;
+uniform vec3 lightDirection;
+out_var vec3 fragColor;
+out_var float fragFog;
+void main() {
+    // instances carry only a transform, so the paint index rides in its unused bottom-left element
+    mat4 transform = instanceTransform;
+    float pick = transform[0][3];
+    transform[0][3] = 0.0;
+    vec4 world = transform * vec4(vertexPosition, 1.0);
+    vec3 normal = normalize((transform * vec4(vertexNormal, 0.0)).xyz);
+    vec3 paint = pick < 0.5 ? vec3(0.80, 0.15, 0.12) : pick < 1.5 ? vec3(0.15, 0.35, 0.75) : pick < 2.5 ? vec3(0.90, 0.85, 0.80) : vec3(0.20, 0.20, 0.22);
+    fragColor = paint * (0.55 + 0.6 * max(dot(normal, lightDirection), 0.0));
+    fragFog = fog_factor(world.xyz);
+    gl_Position = mvp * world;
+}
+)";
+
+constexpr const char *INSTANCED_FS = GLSL_VERSION GLSL_FRAG_OUT R"(
+in_var vec3 fragColor;
+in_var float fragFog;
+uniform vec3 fogColor;
+void main() {
+    FRAG_COLOR = vec4(mix(fragColor, fogColor, fragFog), 1.0);
+}
+)";
+
+// structure of arrays: every step is a pass over contiguous floats
+struct TrafficState {
+    std::array<float, MAX_CARS> x;
+    std::array<float, MAX_CARS> y;
+    std::array<float, MAX_CARS> z;
+    std::array<float, MAX_CARS> heading;
+    std::array<float, MAX_CARS> velocity; // along z, signed by the lane's direction; zero past `count`
+    std::array<float, MAX_CARS> lane;
+    std::array<float, MAX_CARS> paint; // index into the shader's palette
+    std::array<Matrix, MAX_CARS> transforms;
+    std::array<Matrix, MAX_CARS> visible;
+    int32_t count = 0;
+    float span = MIN_SPAN;
+    float cost_us = 0.0f;
+    Mesh mesh = {};
+    Material material = {};
+    bool initialized = false;
+} internal_state;
+
+// a pickup-like silhouette: body and cab, 24 vertices with flat normals per box
+void append_box(Mesh &mesh, Vector3 center, Vector3 size) {
+    constexpr std::array<Vector3, 6> NORMALS = {{{1, 0, 0}, {-1, 0, 0}, {0, 1, 0}, {0, -1, 0}, {0, 0, 1}, {0, 0, -1}}};
+    const int32_t base = mesh.vertexCount;
+    for (int32_t face = 0; face < 6; ++face) {
+        const Vector3 n = NORMALS[static_cast<size_t>(face)];
+        // two axes spanning the face, ordered so the triangles wind counter-clockwise seen from outside
+        const Vector3 u = {n.y + n.z != 0.0f ? 1.0f : 0.0f, n.x != 0.0f ? 1.0f : 0.0f, 0.0f};
+        const Vector3 v = Vector3CrossProduct(n, u);
+        for (int32_t corner = 0; corner < 4; ++corner) {
+            const float su = (corner == 1 || corner == 2) ? 0.5f : -0.5f;
+            const float sv = (corner >= 2) ? 0.5f : -0.5f;
+            const Vector3 p = Vector3Add(Vector3Scale(n, 0.5f), Vector3Add(Vector3Scale(u, su), Vector3Scale(v, sv)));
+            const auto i = static_cast<size_t>(mesh.vertexCount++);
+            mesh.vertices[i * 3] = center.x + p.x * size.x;
+            mesh.vertices[i * 3 + 1] = center.y + p.y * size.y;
+            mesh.vertices[i * 3 + 2] = center.z + p.z * size.z;
+            mesh.normals[i * 3] = n.x;
+            mesh.normals[i * 3 + 1] = n.y;
+            mesh.normals[i * 3 + 2] = n.z;
+        }
+        const auto first = static_cast<unsigned short>(base + face * 4);
+        const std::array<unsigned short, 6> quad = {first, static_cast<unsigned short>(first + 1), static_cast<unsigned short>(first + 2), first, static_cast<unsigned short>(first + 2), static_cast<unsigned short>(first + 3)};
+        std::ranges::copy(quad, mesh.indices + mesh.triangleCount * 3);
+        mesh.triangleCount += 2;
+    }
+}
+
+void ensure_initialized() {
+    auto &s = internal_state;
+    if (s.initialized) {
+        return;
+    }
+    s.initialized = true;
+    if (!IsWindowReady()) {
+        return;
+    }
+    constexpr int32_t BOXES = 2;
+    s.mesh.vertices = static_cast<float *>(MemAlloc(BOXES * 24 * 3 * sizeof(float)));
+    s.mesh.normals = static_cast<float *>(MemAlloc(BOXES * 24 * 3 * sizeof(float)));
+    s.mesh.indices = static_cast<unsigned short *>(MemAlloc(BOXES * 36 * sizeof(unsigned short)));
+    append_box(s.mesh, {0.0f, 0.6f, 0.0f}, {1.8f, 0.8f, 4.2f});
+    append_box(s.mesh, {0.0f, 1.25f, 0.2f}, {1.6f, 0.5f, 1.6f});
+    assert(s.mesh.vertexCount == BOXES * 24);
+    UploadMesh(&s.mesh, false);
+    s.material = LoadMaterialDefault();
+    Shader &shader = s.material.shader;
+    shader = LoadShaderFromMemory(INSTANCED_VS, INSTANCED_FS);
+    shader.locs[SHADER_LOC_MATRIX_MVP] = GetShaderLocation(shader, "mvp");
+    shader.locs[SHADER_LOC_MATRIX_MODEL] = GetShaderLocationAttrib(shader, "instanceTransform");
+    const Vector3 light = Terrain::get_light_direction();
+    SetShaderValue(shader, GetShaderLocation(shader, "lightDirection"), &light, SHADER_UNIFORM_VEC3);
+}
+
+// the focus z each car wraps around; unused entries repeat the first
+using FocusZ = std::array<float, Traffic::MAX_FOCI>;
+static_assert(Traffic::MAX_FOCI == 2, "the wrap compares the foci inline, so the loop stays flat enough to vectorize");
+
+void step_block(int32_t block, float dt, const FocusZ &focus_z) {
+    auto &s = internal_state;
+    const auto begin = static_cast<size_t>(block * BLOCK);
+    const auto end = static_cast<size_t>(std::min((block + 1) * BLOCK, s.count));
+    const size_t n = end - begin;
+    float *__restrict x = s.x.data() + begin;
+    float *__restrict y = s.y.data() + begin;
+    float *__restrict z = s.z.data() + begin;
+    float *__restrict heading = s.heading.data() + begin;
+    const float *__restrict velocity = s.velocity.data() + begin;
+    const float *__restrict lane = s.lane.data() + begin;
+    const float *__restrict paint = s.paint.data() + begin;
+    const float span = s.span;
+    const float period = 2.0f * span;
+    const float first_z = focus_z[0];
+    const float second_z = focus_z[1];
+
+    // the whole block, empty slots included, so the trip count is fixed and gcc's -O2 cost model vectorizes it.
+    // a car wraps by whole laps of the stretch: the truncation is a plain conversion, where a compare or floor would
+    // keep it scalar on sse2. it is exact unless a car is more than a lap behind, which only a jumping focus leaves it;
+    // such a car catches up a lap per step. each car wraps around the nearest focus, so every player keeps traffic
+    for (size_t i = 0; i < static_cast<size_t>(BLOCK); ++i) {
+        const float moved = z[i] + velocity[i] * dt;
+        const float to_first = moved - first_z;
+        const float to_second = moved - second_z;
+        const float offset = std::fabs(to_second) < std::fabs(to_first) ? to_second : to_first;
+        const auto laps = static_cast<int32_t>((offset + 3.0f * span) / period) - 1;
+        z[i] = moved - static_cast<float>(laps) * period;
+    }
+    // the road is noise: one scalar call per car and per lookahead
+    for (size_t i = 0; i < n; ++i) {
+        const float direction = get_direction(lane[i]);
+        x[i] = Terrain::get_road_center_x(z[i]) + lane[i];
+        const float ahead = Terrain::get_road_center_x(z[i] + direction * LOOKAHEAD) + lane[i];
+        heading[i] = std::atan2(ahead - x[i], direction * LOOKAHEAD);
+    }
+    Terrain::get_heights({x, n}, {z, n}, {y, n});
+
+    Matrix *transforms = s.transforms.data() + begin;
+    for (size_t i = 0; i < n; ++i) {
+        const float c = std::cos(heading[i]);
+        const float si = std::sin(heading[i]);
+        // MatrixRotateY(heading) then MatrixTranslate(x, y, z), written out; m3 holds the paint for the shader
+        transforms[i] = {c, 0.0f, si, x[i], 0.0f, 1.0f, 0.0f, y[i], -si, 0.0f, c, z[i], paint[i], 0.0f, 0.0f, 1.0f};
+    }
+}
+
+} // namespace
+
+namespace Traffic {
+
+void spawn(int32_t count, const Vector3 &center) {
+    assert(count >= 0 && count <= MAX_CARS);
+    auto &s = internal_state;
+    const int32_t per_lane = (count + 1) / 2;
+    s.count = count;
+    s.span = std::max(MIN_SPAN, static_cast<float>(per_lane) * CAR_GAP * 0.5f);
+    for (int32_t i = 0; i < count; ++i) {
+        const auto k = static_cast<size_t>(i);
+        const int32_t lane_index = i % 2;
+        const int32_t slot = i / 2;
+        s.lane[k] = lane_index == 0 ? -LANE_OFFSET : LANE_OFFSET;
+        s.velocity[k] = get_direction(s.lane[k]) * LANE_SPEEDS[static_cast<size_t>(lane_index)];
+        s.paint[k] = static_cast<float>((slot * 3 + lane_index) % 4);
+        // evenly spaced over the span, the two lanes staggered by half a gap
+        s.z[k] = center.z - s.span + (static_cast<float>(slot) + 0.5f * static_cast<float>(lane_index)) * (2.0f * s.span / static_cast<float>(std::max(per_lane, 1)));
+    }
+    // empty slots are stepped with their block, so they are parked at rest
+    std::fill(s.velocity.begin() + count, s.velocity.end(), 0.0f);
+    std::fill(s.z.begin() + count, s.z.end(), center.z);
+    update(0.0f, center);
+}
+
+void update(float dt, const Vector3 &focus) { update(dt, std::span(&focus, 1)); }
+
+void update(float dt, std::span<const Vector3> foci) {
+    assert(!foci.empty() && foci.size() <= static_cast<size_t>(MAX_FOCI));
+    auto &s = internal_state;
+    if (s.count == 0) {
+        return;
+    }
+    FocusZ focus_z = {};
+    for (size_t f = 0; f < focus_z.size(); ++f) {
+        focus_z[f] = foci[f < foci.size() ? f : 0].z;
+    }
+    const auto start = std::chrono::steady_clock::now();
+    const int32_t blocks = (s.count + BLOCK - 1) / BLOCK;
+    Jobs::parallel_for(blocks, [&](int32_t block) { step_block(block, dt, focus_z); });
+    const auto elapsed = std::chrono::duration<float, std::micro>(std::chrono::steady_clock::now() - start).count();
+    s.cost_us += (elapsed / static_cast<float>(s.count) - s.cost_us) * SMOOTHING;
+}
+
+void draw(const Camera3D &camera) {
+    ensure_initialized();
+    auto &s = internal_state;
+    if (s.count == 0 || s.mesh.vboId == nullptr) {
+        return;
+    }
+    // cars past the fog are invisible, so only the rest are uploaded as instances
+    const float cull = Fog::get_cull_distance();
+    int32_t visible = 0;
+    for (int32_t i = 0; i < s.count; ++i) {
+        const auto k = static_cast<size_t>(i);
+        const float dx = s.x[k] - camera.position.x;
+        const float dz = s.z[k] - camera.position.z;
+        if (dx * dx + dz * dz < cull * cull) {
+            s.visible[static_cast<size_t>(visible++)] = s.transforms[k];
+        }
+    }
+    if (visible == 0) {
+        return;
+    }
+    Fog::apply(s.material.shader);
+    DrawMeshInstanced(s.mesh, s.material, s.visible.data(), visible);
+}
+
+int32_t get_count() { return internal_state.count; }
+
+Vector3 get_position(int32_t index) {
+    assert(index >= 0 && index < internal_state.count);
+    const auto k = static_cast<size_t>(index);
+    return {internal_state.x[k], internal_state.y[k], internal_state.z[k]};
+}
+
+float get_heading(int32_t index) {
+    assert(index >= 0 && index < internal_state.count);
+    return internal_state.heading[static_cast<size_t>(index)];
+}
+
+float get_lane(int32_t index) {
+    assert(index >= 0 && index < internal_state.count);
+    return internal_state.lane[static_cast<size_t>(index)];
+}
+
+float get_cost_us() { return internal_state.cost_us; }
+
+void cleanup() {
+    auto &s = internal_state;
+    if (s.mesh.vboId != nullptr) {
+        UnloadMesh(s.mesh);
+        UnloadMaterial(s.material);
+    }
+    s.mesh = {};
+    s.material = {};
+    s.count = 0;
+    s.cost_us = 0.0f;
+    s.initialized = false;
+}
+
+} // namespace Traffic
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "raylib.h"
+#include <cstdint>
+#include <span>
+
+namespace Traffic {
+
+constexpr int32_t MAX_FOCI = 2; // one per split-screen player
+
+/** replaces the npc population with `count` cars spread evenly along both lanes of the road around `center` */
+void spawn(int32_t count, const Vector3 &center);
+
+/** steps every car along the road on the worker threads; cars too far from `focus` re-enter on the other side */
+void update(float dt, const Vector3 &focus);
+
+/** steps every car like the single-focus update, each wrapping around the nearest of `foci` (at most `MAX_FOCI`), so
+    every player drives through traffic however far apart they are */
+void update(float dt, std::span<const Vector3> foci);
+
+/** draws the cars within fog range of the camera with one instanced draw */
+void draw(const Camera3D &camera);
+
+//
+// getters
+//
+
+/** returns the number of simulated cars */
+int32_t get_count();
+
+/** returns the position of car `index` (wheels on the terrain) */
+Vector3 get_position(int32_t index);
+
+/** returns the heading of car `index` (radians, like the player car) */
+float get_heading(int32_t index);
+
+/** returns the signed offset of car `index`'s lane from the road center */
+float get_lane(int32_t index);
+
+/** returns the running average update cost per car (microseconds) */
+float get_cost_us();
+
+/** frees the cars and their gpu resources */
+void cleanup();
+
+} // namespace Traffic
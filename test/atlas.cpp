@@ -0,0 +1,69 @@
+#include "atlas.hpp"
+#include "terrain.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace {
+
+// ctest runs every test as its own process, possibly in parallel: each one gets its own file
+std::filesystem::path temp_atlas_path() {
+    const std::string test = ::testing::UnitTest::GetInstance()->current_test_info()->name();
+    return std::filesystem::temp_directory_path() / ("silly_roads_" + test + ".atlas");
+}
+
+} // namespace
+
+TEST(AtlasTest, StreamsBakedChunksIdenticalToProcedural) {
+    const std::filesystem::path path = temp_atlas_path();
+    ASSERT_TRUE(Atlas::bake(path.string(), -2, -2, 3, 3));
+    ASSERT_TRUE(Atlas::open(path.string()));
+
+    // the window around the origin straddles the baked region and its procedural fallback
+    Terrain::update({0.0f, 0.0f, 0.0f});
+    const auto n = static_cast<size_t>(Terrain::get_chunk_resolution() * Terrain::get_chunk_resolution());
+    std::vector<float> vertices(n * 3);
+    std::vector<float> normals(n * 3);
+    std::vector<unsigned char> colors(n * 4);
+    for (int32_t cz = -2; cz <= 2; ++cz) {
+        for (int32_t cx = -2; cx <= 2; ++cx) {
+            const Mesh *mesh = Terrain::find_chunk_mesh(cx, cz);
+            ASSERT_NE(mesh, nullptr);
+            const bool baked = Atlas::find_tile(cx, cz).has_value();
+            EXPECT_EQ(baked, cx <= 0 && cz <= 0) << cx << "," << cz;
+            if (baked) {
+                EXPECT_EQ(mesh->vertices, Atlas::find_tile(cx, cz)->vertices) << "baked chunks must not be copied";
+            }
+
+            Mesh expected = {};
+            expected.vertices = vertices.data();
+            expected.normals = normals.data();
+            expected.colors = colors.data();
+            Terrain::generate_chunk(expected, cx, cz);
+            EXPECT_TRUE(std::equal(vertices.begin(), vertices.end(), mesh->vertices));
+            EXPECT_TRUE(std::equal(normals.begin(), normals.end(), mesh->normals));
+            EXPECT_TRUE(std::equal(colors.begin(), colors.end(), mesh->colors));
+        }
+    }
+
+    Terrain::cleanup();
+    Atlas::cleanup();
+    std::filesystem::remove(path);
+}
+
+TEST(AtlasTest, RejectsMissingAndTruncatedFiles) {
+    const std::filesystem::path path = temp_atlas_path();
+    std::filesystem::remove(path);
+    EXPECT_FALSE(Atlas::open(path.string()));
+
+    ASSERT_TRUE(Atlas::bake(path.string(), 0, 0, 1, 1));
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 1);
+    EXPECT_FALSE(Atlas::open(path.string()));
+    EXPECT_FALSE(Atlas::find_tile(0, 0).has_value());
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,36 @@
+#include "fog.hpp"
+#include "terrain.hpp"
+
+#include <gtest/gtest.h>
+
+TEST(FogTest, ClearNearOpaqueAtTheViewDistance) {
+    Fog::configure(Terrain::get_view_distance());
+    const float view = Terrain::get_view_distance();
+    EXPECT_FLOAT_EQ(Fog::get_factor(0.0f), 0.0f);
+    EXPECT_LT(Fog::get_factor(view * 0.25f), 0.15f);
+    EXPECT_NEAR(Fog::get_factor(view), 0.85f, 1e-4f);
+    EXPECT_NEAR(Fog::get_factor(Fog::get_cull_distance()), 0.99f, 1e-4f);
+    // the chunks have to be gone into the fog before the landscape is
+    EXPECT_GT(Fog::get_cull_distance(), view);
+    float previous = 0.0f;
+    for (float d = 1.0f; d < view * 2.0f; d += 1.0f) {
+        const float factor = Fog::get_factor(d);
+        EXPECT_GE(factor, previous) << d;
+        EXPECT_LE(factor, 1.0f) << d;
+        previous = factor;
+    }
+    Fog::cleanup();
+}
+
+TEST(FogTest, FollowsTheRepresentation) {
+    Fog::configure(Terrain::get_view_distance());
+    const float chunks = Fog::get_cull_distance();
+    Terrain::set_representation(Terrain::Representation::CLIPMAP);
+    Fog::configure(Terrain::get_view_distance());
+    EXPECT_GT(Fog::get_cull_distance(), chunks * 10.0f);
+    Terrain::set_representation(Terrain::Representation::CHUNKS);
+    Fog::cleanup();
+    // unconfigured fog is off
+    EXPECT_FLOAT_EQ(Fog::get_factor(1e6f), 0.0f);
+    Terrain::cleanup();
+}
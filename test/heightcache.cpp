@@ -0,0 +1,103 @@
+#include "heightcache.hpp"
+#include "terrain.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace {
+
+// samples spread over the streamed window around the origin, lattice points included
+std::vector<Vector2> sample_points() {
+    std::mt19937 rng{7};
+    // the window around the origin spans chunks [-2, 2], i.e. [-2, 3) chunk sizes
+    std::uniform_real_distribution<float> dist(-2.0f * Terrain::get_chunk_size(), 3.0f * Terrain::get_chunk_size() - 1.0f);
+    std::vector<Vector2> points;
+    for (int32_t i = 0; i < 4096; ++i) {
+        points.push_back({dist(rng), dist(rng)});
+        points.push_back({std::round(points.back().x), std::round(points.back().y)});
+    }
+    return points;
+}
+
+std::vector<float> cached_heights(HeightCache::Encoding encoding, const std::vector<Vector2> &points) {
+    HeightCache::configure(encoding);
+    Terrain::update({0.0f, 0.0f, 0.0f});
+    std::vector<float> heights;
+    for (const Vector2 &p : points) {
+        heights.push_back(HeightCache::sample(p.x, p.y).value_or(NAN));
+    }
+    Terrain::cleanup();
+    return heights;
+}
+
+} // namespace
+
+TEST(HeightCacheTest, DisabledCacheKeepsExactNoise) {
+    HeightCache::configure(HeightCache::Encoding::OFF);
+    Terrain::update({0.0f, 0.0f, 0.0f});
+    EXPECT_FALSE(HeightCache::sample(1.0f, 1.0f).has_value());
+    Terrain::cleanup();
+}
+
+TEST(HeightCacheTest, Float32MatchesNoiseOnLattice) {
+    std::vector<Vector2> lattice;
+    std::vector<float> exact;
+    for (int32_t z = -100; z <= 100; z += 7) {
+        for (int32_t x = -100; x <= 100; x += 5) {
+            lattice.push_back({static_cast<float>(x), static_cast<float>(z)});
+            exact.push_back(Terrain::get_height(lattice.back().x, lattice.back().y));
+        }
+    }
+    const std::vector<float> cached = cached_heights(HeightCache::Encoding::FLOAT32, lattice);
+    for (size_t i = 0; i < lattice.size(); ++i) {
+        EXPECT_EQ(cached[i], exact[i]) << lattice[i].x << "," << lattice[i].y;
+    }
+    HeightCache::cleanup();
+}
+
+TEST(HeightCacheTest, CompressedEncodingsStayCloseToFloat) {
+    const std::vector<Vector2> points = sample_points();
+    const std::vector<float> reference = cached_heights(HeightCache::Encoding::FLOAT32, points);
+    const std::vector<float> q16 = cached_heights(HeightCache::Encoding::QUANTIZED16, points);
+    const std::vector<float> delta8 = cached_heights(HeightCache::Encoding::DELTA8, points);
+    float q16_error = 0.0f;
+    float delta8_error = 0.0f;
+    for (size_t i = 0; i < points.size(); ++i) {
+        ASSERT_FALSE(std::isnan(reference[i]));
+        q16_error = std::max(q16_error, std::abs(q16[i] - reference[i]));
+        delta8_error = std::max(delta8_error, std::abs(delta8[i] - reference[i]));
+    }
+    EXPECT_LT(q16_error, 1e-3f);
+    EXPECT_LT(delta8_error, 2e-2f);
+    HeightCache::cleanup();
+}
+
+TEST(HeightCacheTest, SmallerEncodingsHoldMoreChunks) {
+    HeightCache::configure(HeightCache::Encoding::FLOAT32);
+    const int32_t f32 = HeightCache::get_capacity();
+    HeightCache::configure(HeightCache::Encoding::QUANTIZED16);
+    const int32_t q16 = HeightCache::get_capacity();
+    HeightCache::configure(HeightCache::Encoding::DELTA8);
+    const int32_t delta8 = HeightCache::get_capacity();
+    EXPECT_GE(q16, 2 * f32);
+    EXPECT_GT(delta8, q16);
+    HeightCache::cleanup();
+}
+
+TEST(HeightCacheTest, RevisitedTerrainStaysCachedAfterDrivingAway) {
+    HeightCache::configure(HeightCache::Encoding::DELTA8);
+    Terrain::update({0.0f, 0.0f, 0.0f});
+    // drive far enough that the origin leaves the streaming window but not the cache
+    for (int32_t step = 0; step < 20; ++step) {
+        Terrain::update({0.0f, 0.0f, static_cast<float>(step) * Terrain::get_chunk_size()});
+    }
+    EXPECT_TRUE(HeightCache::sample(1.0f, 1.0f).has_value());
+    EXPECT_EQ(Terrain::find_chunk_mesh(0, 0), nullptr);
+    Terrain::cleanup();
+    HeightCache::cleanup();
+}
@@ -0,0 +1,115 @@
+#include "heightring.hpp"
+#include "terrain.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+TEST(HeightRingTest, MatchesExactSurfaceOnLattice) {
+    Terrain::set_representation(Terrain::Representation::RING);
+    Terrain::update({10.0f, 0.0f, -20.0f});
+    for (int32_t z = -100; z <= 100; z += 7) {
+        for (int32_t x = -100; x <= 100; x += 5) {
+            const auto fx = static_cast<float>(x);
+            const auto fz = static_cast<float>(z);
+            ASSERT_TRUE(HeightRing::sample(fx, fz).has_value()) << x << "," << z;
+            EXPECT_EQ(*HeightRing::sample(fx, fz), Terrain::sample_surface(fx, fz, false).height) << x << "," << z;
+        }
+    }
+    Terrain::set_representation(Terrain::Representation::CHUNKS);
+}
+
+TEST(HeightRingTest, ScrollingGeneratesOnlyExposedRowsAndColumns) {
+    Terrain::set_representation(Terrain::Representation::RING);
+    const int64_t n = HeightRing::get_resolution();
+    Terrain::update({0.0f, 0.0f, 0.0f});
+    EXPECT_EQ(HeightRing::get_generated_count(), n * n);
+
+    // origins snap to even lattice lines: small moves regenerate nothing, crossing one regenerates two columns or rows
+    Terrain::update({1.5f, 0.0f, 1.5f});
+    EXPECT_EQ(HeightRing::get_generated_count(), n * n);
+    Terrain::update({2.5f, 0.0f, 0.5f});
+    EXPECT_EQ(HeightRing::get_generated_count(), n * n + 2 * n);
+    Terrain::update({2.5f, 0.0f, 2.5f});
+    EXPECT_EQ(HeightRing::get_generated_count(), n * n + 4 * n);
+    Terrain::set_representation(Terrain::Representation::CHUNKS);
+}
+
+TEST(HeightRingTest, ClipmapReachesKilometersAtBoundedCost) {
+    Terrain::set_representation(Terrain::Representation::CLIPMAP);
+    EXPECT_GT(HeightRing::get_extent(), 4000.0f);
+    const int64_t n = HeightRing::get_resolution();
+    Terrain::update({0.0f, 0.0f, 0.0f});
+    const int64_t initial = HeightRing::get_generated_count();
+    EXPECT_EQ(initial % (n * n), 0);
+
+    // coarse levels sample the exact surface on their own lattice
+    for (const float x : {-2976.0f, -1024.0f, 640.0f, 2048.0f}) {
+        const std::optional<float> h = HeightRing::sample(x, 1024.0f);
+        ASSERT_TRUE(h.has_value()) << x;
+        EXPECT_EQ(*h, Terrain::sample_surface(x, 1024.0f, false).height) << x;
+    }
+
+    // every level scrolls at most once per step, so per-step work is bounded by the ring size, not the view distance
+    for (int32_t step = 1; step <= 200; ++step) {
+        const int64_t before = HeightRing::get_generated_count();
+        Terrain::update({static_cast<float>(step), 0.0f, 0.0f});
+        EXPECT_LE(HeightRing::get_generated_count() - before, (initial / (n * n)) * 2 * n);
+    }
+    Terrain::set_representation(Terrain::Representation::CHUNKS);
+}
+
+TEST(HeightRingTest, ScrollingUploadsOnlyRegeneratedVertices) {
+    Terrain::set_representation(Terrain::Representation::CLIPMAP);
+    Terrain::update({0.0f, 0.0f, 0.0f});
+    EXPECT_EQ(HeightRing::get_uploaded_count(), HeightRing::get_generated_count());
+
+    // a coarser level re-triangulates around its scrolled finer level, but its vertices stay where they were
+    for (int32_t step = 1; step <= 200; ++step) {
+        const int64_t generated = HeightRing::get_generated_count();
+        const int64_t uploaded = HeightRing::get_uploaded_count();
+        Terrain::update({static_cast<float>(step) * 0.7f, 0.0f, static_cast<float>(step) * -1.3f});
+        EXPECT_EQ(HeightRing::get_uploaded_count() - uploaded, HeightRing::get_generated_count() - generated) << step;
+    }
+    Terrain::set_representation(Terrain::Representation::CHUNKS);
+}
+
+TEST(HeightRingTest, IncrementalRingMatchesFreshRing) {
+    const auto sample_around = [](const Vector3 &center) {
+        std::vector<float> heights;
+        for (int32_t z = -120; z <= 120; z += 3) {
+            for (int32_t x = -120; x <= 120; x += 3) {
+                const std::optional<float> h = HeightRing::sample(center.x + static_cast<float>(x) + 0.25f, center.z + static_cast<float>(z) + 0.5f);
+                heights.push_back(h.value_or(NAN));
+            }
+        }
+        return heights;
+    };
+
+    // drive diagonally one way and back so every scroll direction wraps the seam
+    Terrain::set_representation(Terrain::Representation::RING);
+    Vector3 pos = {};
+    for (int32_t step = 0; step < 300; ++step) {
+        pos = {static_cast<float>(step) * 0.9f, 0.0f, static_cast<float>(step) * -0.7f};
+        Terrain::update(pos);
+    }
+    for (int32_t step = 0; step < 100; ++step) {
+        pos = {270.0f - static_cast<float>(step) * 1.3f, 0.0f, -210.0f + static_cast<float>(step) * 0.4f};
+        Terrain::update(pos);
+    }
+    const std::vector<float> incremental = sample_around(pos);
+
+    Terrain::set_representation(Terrain::Representation::RING);
+    Terrain::update(pos);
+    const std::vector<float> fresh = sample_around(pos);
+    Terrain::set_representation(Terrain::Representation::CHUNKS);
+
+    ASSERT_EQ(incremental.size(), fresh.size());
+    for (size_t i = 0; i < fresh.size(); ++i) {
+        ASSERT_FALSE(std::isnan(fresh[i]));
+        EXPECT_EQ(incremental[i], fresh[i]) << i;
+    }
+}
@@ -0,0 +1,41 @@
+#include "horizon.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+
+TEST(HorizonTest, RerendersOnlyAfterMovingFarEnough) {
+    Horizon::update({0.0f, 50.0f, 0.0f});
+    EXPECT_EQ(Horizon::get_render_count(), 1);
+    Horizon::update({10.0f, 50.0f, 10.0f});
+    EXPECT_EQ(Horizon::get_render_count(), 1);
+    Horizon::update({100.0f, 50.0f, 0.0f});
+    EXPECT_EQ(Horizon::get_render_count(), 2);
+    Horizon::cleanup();
+}
+
+TEST(HorizonTest, SilhouetteSeparatesGroundFromSky) {
+    // from well above the terrain, the top of the panorama is sky and the bottom is ground in every direction
+    Horizon::update({0.0f, 50.0f, 0.0f});
+    for (int32_t column = 0; column < 512; column += 16) {
+        EXPECT_EQ(Horizon::get_pixel(column, 0).a, 0) << column;
+        EXPECT_EQ(Horizon::get_pixel(column, 63).a, 255) << column;
+    }
+    Horizon::cleanup();
+}
+
+TEST(HorizonTest, EachPlayerHasTheirOwnPanorama) {
+    Horizon::update({0.0f, 50.0f, 0.0f}, 0);
+    // far below the first eye, the second one sees ground above the eye plane where the first sees sky
+    Horizon::update({5000.0f, -200.0f, 5000.0f}, 1);
+    EXPECT_EQ(Horizon::get_render_count(), 2);
+    int32_t differing = 0;
+    for (int32_t column = 0; column < 512; column += 16) {
+        differing += Horizon::get_pixel(column, 0, 0).a != Horizon::get_pixel(column, 0, 1).a ? 1 : 0;
+    }
+    EXPECT_GT(differing, 0);
+    // the first panorama is not re-rendered by the second player's eye
+    Horizon::update({0.0f, 50.0f, 0.0f}, 0);
+    EXPECT_EQ(Horizon::get_render_count(), 2);
+    Horizon::cleanup();
+}
@@ -0,0 +1,87 @@
+#include "landscape.hpp"
+#include "terrain.hpp"
+#include "traffic.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace {
+
+constexpr Vector2 CAR_HALF_EXTENTS = {1.0f, 2.35f};
+
+void populate(const Vector3 &center, int32_t updates) {
+    for (int32_t i = 0; i < updates; ++i) {
+        Landscape::update(center);
+    }
+}
+
+} // namespace
+
+TEST(LandscapeTest, ContactPushesTheFootprintClear) {
+    populate(Terrain::get_start_position(), 200);
+    ASSERT_GT(Landscape::get_count(), 0);
+    for (int32_t i = 0; i < std::min(Landscape::get_count(), 50); ++i) {
+        const Vector3 p = Landscape::get_position(i);
+        // park the car with the element under its body, at an angle
+        Vector2 center = {p.x + 0.6f, p.z + 0.3f};
+        const float heading = 0.4f * static_cast<float>(i);
+        const auto contact = Landscape::collide(center, CAR_HALF_EXTENTS, heading);
+        ASSERT_TRUE(contact.has_value()) << i;
+        EXPECT_GT(contact->depth, 0.0f) << i;
+        EXPECT_NEAR(std::hypot(contact->normal.x, contact->normal.y), 1.0f, 1e-4f) << i;
+        center.x += contact->normal.x * (contact->depth + 1e-3f);
+        center.y += contact->normal.y * (contact->depth + 1e-3f);
+        const auto after = Landscape::collide(center, CAR_HALF_EXTENTS, heading);
+        EXPECT_TRUE(!after.has_value() || after->depth < 1e-2f) << i;
+    }
+    Landscape::cleanup();
+    Terrain::cleanup();
+}
+
+TEST(LandscapeTest, OpenGroundHasNoContact) {
+    const Vector3 start = Terrain::get_start_position();
+    populate(start, 200);
+    // the road is kept clear of trees and bushes
+    for (float dz = -100.0f; dz <= 100.0f; dz += 5.0f) {
+        const float z = start.z + dz;
+        EXPECT_FALSE(Landscape::collide({Terrain::get_road_center_x(z), z}, CAR_HALF_EXTENTS, 0.0f).has_value()) << dz;
+    }
+    Landscape::cleanup();
+    Terrain::cleanup();
+}
+
+TEST(LandscapeTest, CollisionWorkIsIndependentOfLoad) {
+    const Vector3 start = Terrain::get_start_position();
+    const auto worst_tests = [&] {
+        int32_t worst = 0;
+        for (int32_t i = 0; i < Landscape::get_count(); ++i) {
+            const Vector3 p = Landscape::get_position(i);
+            Landscape::collide({p.x, p.z}, CAR_HALF_EXTENTS, 0.0f);
+            worst = std::max(worst, Landscape::get_collision_tests());
+        }
+        return worst;
+    };
+    populate(start, 20);
+    const int32_t sparse_count = Landscape::get_count();
+    const int32_t sparse = worst_tests();
+    populate(start, 2000);
+    ASSERT_GT(Landscape::get_count(), sparse_count * 4);
+    const int32_t dense = worst_tests();
+    // a handful of grid cells around the car, never the whole population
+    EXPECT_LE(dense, 16);
+    EXPECT_LT(dense, Landscape::get_count() / 20);
+    EXPECT_GE(dense, sparse);
+    // npc traffic lives outside the landscape grid and adds nothing to the player's query
+    const Vector3 p = Landscape::get_position(0);
+    Landscape::collide({p.x, p.z}, CAR_HALF_EXTENTS, 0.0f);
+    const int32_t without_traffic = Landscape::get_collision_tests();
+    Traffic::spawn(2000, start);
+    Landscape::collide({p.x, p.z}, CAR_HALF_EXTENTS, 0.0f);
+    EXPECT_EQ(Landscape::get_collision_tests(), without_traffic);
+    Traffic::cleanup();
+    Landscape::cleanup();
+    Terrain::cleanup();
+}
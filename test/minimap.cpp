@@ -0,0 +1,49 @@
+#include "minimap.hpp"
+#include "terrain.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+namespace {
+
+bool is_road(Color c) { return c.r == 30 && c.g == 30 && c.b == 30; }
+
+} // namespace
+
+TEST(MinimapTest, RasterizesOnlyNewlyResidentChunks) {
+    const float chunk = Terrain::get_chunk_size();
+    const Vector3 origin = {0.5f * chunk, 0.0f, 0.5f * chunk};
+    Terrain::update(origin);
+    Minimap::update(origin);
+    // the whole 5x5 resident window is new
+    EXPECT_EQ(Minimap::get_tile_updates(), 25);
+    Minimap::update(origin);
+    EXPECT_EQ(Minimap::get_tile_updates(), 25);
+
+    // one chunk forward exposes one new row of five
+    const Vector3 next = {origin.x, 0.0f, origin.z + chunk};
+    Terrain::update(next);
+    Minimap::update(next);
+    EXPECT_EQ(Minimap::get_tile_updates(), 30);
+
+    Minimap::cleanup();
+    Terrain::cleanup();
+}
+
+TEST(MinimapTest, ShowsTheRoadFromItsCenterline) {
+    const float chunk = Terrain::get_chunk_size();
+    const Vector3 origin = {0.5f * chunk, 0.0f, 0.5f * chunk};
+    Terrain::update(origin);
+    Minimap::update(origin);
+    for (float z = -chunk; z < 2.0f * chunk; z += 7.0f) {
+        const float road = Terrain::get_road_center_x(z);
+        if (std::abs(road - origin.x) > chunk) {
+            continue; // outside the resident window
+        }
+        EXPECT_TRUE(is_road(Minimap::get_pixel(road, z))) << z;
+        EXPECT_FALSE(is_road(Minimap::get_pixel(road + 20.0f, z))) << z;
+    }
+    Minimap::cleanup();
+    Terrain::cleanup();
+}
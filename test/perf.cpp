@@ -0,0 +1,247 @@
+#include "car.hpp"
+#include "frustum.hpp"
+#include "landscape.hpp"
+#include "renderqueue.hpp"
+#include "terrain.hpp"
+#include "traffic.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <numeric>
+#include <span>
+#include <string_view>
+
+namespace {
+
+// kernels are timed relative to a fixed calibration loop, so the baseline is a ratio that transfers
+// between machines. recorded from the default (sanitized) `make test` build; regenerate by running
+// `perf_binary` and copying the printed ratios. uninstrumented builds only come in lower.
+struct Baseline {
+    std::string_view name;
+    double ratio;
+};
+constexpr std::array<Baseline, 7> BASELINE = {{
+    {"height", 2.8},
+    {"road", 2.7},
+    {"chunks", 25.0},
+    {"drive", 7.5},
+    {"raycast", 4.8},
+    {"traffic", 11.5},
+    {"split", 47.0},
+}};
+
+constexpr int32_t REPETITIONS = 9;
+constexpr double TOLERANCE = 2.0;
+
+volatile float sink = 0.0f;
+
+double baseline_ratio(std::string_view name) {
+    const auto it = std::ranges::find(BASELINE, name, &Baseline::name);
+    return it == BASELINE.end() ? 0.0 : it->ratio;
+}
+
+// gradient-table float math with the same flavor as the noise kernels
+void calibrate() {
+    std::array<int32_t, 512> p;
+    std::iota(p.begin(), p.end(), 0);
+    float acc = 0.0f;
+    for (int32_t i = 0; i < 1 << 18; ++i) {
+        const float x = static_cast<float>(i) * 0.37f;
+        const float t = x - std::floor(x);
+        const float fade = t * t * t * (t * (t * 6 - 15) + 10);
+        acc += fade * static_cast<float>(p[static_cast<size_t>(i & 511)] & 15);
+    }
+    sink = acc;
+}
+
+template <typename F>
+double seconds(F &&fn) {
+    const auto start = std::chrono::steady_clock::now();
+    fn();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// min-of-n with kernel and calibration interleaved, so load spikes hit both sides equally
+template <typename F>
+double relative_cost(F &&kernel) {
+    double best_kernel = std::numeric_limits<double>::max();
+    double best_calibration = std::numeric_limits<double>::max();
+    for (int32_t rep = 0; rep < REPETITIONS; ++rep) {
+        best_calibration = std::min(best_calibration, seconds(calibrate));
+        best_kernel = std::min(best_kernel, seconds(kernel));
+    }
+    return best_kernel / best_calibration;
+}
+
+void expect_within_baseline(std::string_view name, double ratio) {
+    std::printf("perf %.*s %.4f\n", static_cast<int>(name.size()), name.data(), ratio);
+    const double baseline = baseline_ratio(name);
+    if (baseline <= 0.0) {
+        GTEST_SKIP() << "no baseline recorded for " << name;
+    }
+    EXPECT_LE(ratio, baseline * TOLERANCE) << name << " regressed: " << ratio << " vs baseline " << baseline;
+}
+
+} // namespace
+
+TEST(PerfTest, Height) {
+    const double ratio = relative_cost([] {
+        float acc = 0.0f;
+        for (int32_t z = 0; z < 256; ++z) {
+            for (int32_t x = 0; x < 256; ++x) {
+                acc += Terrain::get_height(static_cast<float>(x) * 0.7f, static_cast<float>(z) * 0.7f);
+            }
+        }
+        sink = acc;
+    });
+    expect_within_baseline("height", ratio);
+}
+
+TEST(PerfTest, Road) {
+    const double ratio = relative_cost([] {
+        float acc = 0.0f;
+        for (int32_t z = 0; z < 1 << 16; ++z) {
+            acc += Terrain::get_road_center_x(static_cast<float>(z) * 0.5f);
+        }
+        sink = acc;
+    });
+    expect_within_baseline("road", ratio);
+}
+
+TEST(PerfTest, Chunks) {
+    // every jump lands outside the previous window, so the whole window is regenerated
+    float jump = 0.0f;
+    const double ratio = relative_cost([&] {
+        jump += 10000.0f;
+        Terrain::update({0.0f, 0.0f, jump});
+    });
+    Terrain::cleanup();
+    expect_within_baseline("chunks", ratio);
+}
+
+TEST(PerfTest, Drive) {
+    // headless drive along the road: chunk streaming, landscape spawning and wheel sampling
+    float z = 0.0f;
+    const double ratio = relative_cost([&] {
+        constexpr float DT = 1.0f / 60.0f;
+        constexpr float SPEED = 50.0f;
+        float acc = 0.0f;
+        for (int32_t step = 0; step < 120; ++step) {
+            z += SPEED * DT;
+            const float x = Terrain::get_road_center_x(z) + 1.5f;
+            const Vector3 pos = {x, Terrain::get_height(x, z), z};
+            Terrain::update(pos);
+            Landscape::update(pos);
+            for (const auto &[ox, oz] : {std::pair{-1.0f, 1.5f}, std::pair{1.0f, 1.5f}, std::pair{-1.0f, -1.5f}, std::pair{1.0f, -1.5f}}) {
+                acc += Terrain::get_height(x + ox, z + oz);
+            }
+        }
+        sink = acc;
+    });
+    Landscape::cleanup();
+    Terrain::cleanup();
+    expect_within_baseline("drive", ratio);
+}
+
+TEST(PerfTest, Raycast) {
+    // spring-arm and picking sized rays fanned around the car over resident chunks
+    const Vector3 start = Terrain::get_start_position();
+    Terrain::update(start);
+    const double ratio = relative_cost([&] {
+        float acc = 0.0f;
+        for (int32_t i = 0; i < 1024; ++i) {
+            const float angle = static_cast<float>(i) * 0.37f;
+            const float pitch = 0.05f + static_cast<float>(i % 16) * 0.03f;
+            const Vector3 origin = {start.x, start.y + 6.0f, start.z};
+            const Vector3 dir = {std::cos(angle) * std::cos(pitch), -std::sin(pitch), std::sin(angle) * std::cos(pitch)};
+            if (const auto hit = Terrain::raycast(origin, dir, 100.0f)) {
+                acc += hit->distance;
+            }
+        }
+        sink = acc;
+    });
+    Terrain::cleanup();
+    expect_within_baseline("raycast", ratio);
+}
+
+TEST(PerfTest, Traffic) {
+    // ten frames of the full npc population, and the per-car cost against a population eight times smaller
+    const Vector3 center = Terrain::get_start_position();
+    const auto simulate = [&](int32_t count) {
+        Traffic::spawn(count, center);
+        return relative_cost([&] {
+            for (int32_t step = 0; step < 10; ++step) {
+                Traffic::update(1.0f / 60.0f, center);
+            }
+        });
+    };
+    const double small = simulate(512);
+    const double large = simulate(4096);
+    Traffic::cleanup();
+    Terrain::cleanup();
+    // linear scaling: eight times the cars costs about eight times as much
+    EXPECT_LT(large / 4096.0, small / 512.0 * 2.0) << "per-car cost grew with the population";
+    expect_within_baseline("traffic", large);
+}
+
+TEST(PerfTest, SplitScreen) {
+    // headless split-screen frames: streaming is shared by both cars, culling and queueing run once per view.
+    // every repetition starts on a fresh stretch of road, so each streams in a whole window and then drives on
+    const auto frames = [](int32_t players, float &start_z) {
+        constexpr float DT = 1.0f / 60.0f;
+        constexpr float SPEED = 50.0f;
+        constexpr std::array<float, 2> LANES = {1.5f, -1.5f};
+        start_z += 10000.0f;
+        float z = start_z;
+        for (int32_t frame = 0; frame < 60; ++frame) {
+            z += SPEED * DT;
+            std::array<Terrain::Focus, 2> foci = {};
+            for (int32_t player = 0; player < players; ++player) {
+                const auto p = static_cast<size_t>(player);
+                const float x = Terrain::get_road_center_x(z) + LANES[p];
+                foci[p] = {.position = {x, Terrain::get_height(x, z), z}, .priority = 1};
+            }
+            const auto active = std::span(foci.data(), static_cast<size_t>(players));
+            Terrain::update(active);
+            Landscape::update(active);
+            for (const Terrain::Focus &focus : active) {
+                const Vector3 car = focus.position;
+                const Camera3D camera = {.position = {car.x, car.y + 8.0f, car.z - 15.0f}, .target = car, .up = {0.0f, 1.0f, 0.0f}, .fovy = 45.0f, .projection = CAMERA_PERSPECTIVE};
+                const std::array views = {Frustum::from_camera(camera, 16.0f / 9.0f)};
+                RenderQueue::begin(camera);
+                RenderQueue::submit_custom(RenderQueue::Pass::OPAQUE, RenderQueue::State::TERRAIN, camera.position, Terrain::draw);
+                Landscape::draw(views);
+                Car::draw();
+                RenderQueue::flush();
+            }
+        }
+    };
+    // single and split repetitions are interleaved like kernel and calibration, so a load spike hits both
+    float single_z = 0.0f;
+    float split_z = -200000.0f;
+    double best_single = std::numeric_limits<double>::max();
+    double best_split = std::numeric_limits<double>::max();
+    double best_calibration = std::numeric_limits<double>::max();
+    for (int32_t rep = 0; rep < REPETITIONS; ++rep) {
+        best_calibration = std::min(best_calibration, seconds(calibrate));
+        Car::set_player_count(1);
+        best_single = std::min(best_single, seconds([&] { frames(1, single_z); }));
+        Car::set_player_count(2);
+        best_split = std::min(best_split, seconds([&] { frames(2, split_z); }));
+    }
+    Car::set_player_count(1);
+    Landscape::cleanup();
+    Terrain::cleanup();
+    const double single = best_single / best_calibration;
+    const double split = best_split / best_calibration;
+    // the second view adds culling and queueing, not a second world
+    EXPECT_LT(split, single * 1.6) << "split " << split << " vs single " << single;
+    expect_within_baseline("split", split);
+}
@@ -0,0 +1,85 @@
+#include "terrain.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdint>
+#include <random>
+
+namespace {
+
+// checks that `hit` lies on the surface and that nothing along the ray before it is underground
+void expect_first_hit(Vector3 origin, Vector3 dir, const Terrain::RayHit &hit) {
+    // chunk triangles and get_height interpolate the same vertices differently, by a few centimeters at most
+    constexpr float TOLERANCE = 0.1f;
+    EXPECT_NEAR(hit.point.y, Terrain::get_height(hit.point.x, hit.point.z), TOLERANCE);
+    EXPECT_GT(hit.normal.y, 0.0f);
+    for (int32_t k = 0; k < 32; ++k) {
+        const float t = hit.distance * static_cast<float>(k) / 32.0f;
+        const Vector3 p = Vector3{origin.x + dir.x * t, origin.y + dir.y * t, origin.z + dir.z * t};
+        EXPECT_GT(p.y, Terrain::get_height(p.x, p.z) - TOLERANCE) << t << " of " << hit.distance;
+    }
+}
+
+} // namespace
+
+TEST(RaycastTest, VerticalRaysLandOnTheVertices) {
+    const Vector3 start = Terrain::get_start_position();
+    Terrain::update(start);
+    for (int32_t z = -40; z <= 40; z += 7) {
+        for (int32_t x = -40; x <= 40; x += 7) {
+            const float wx = std::floor(start.x) + static_cast<float>(x);
+            const float wz = std::floor(start.z) + static_cast<float>(z);
+            const auto hit = Terrain::raycast({wx, 50.0f, wz}, {0.0f, -1.0f, 0.0f}, 100.0f);
+            ASSERT_TRUE(hit.has_value()) << wx << ", " << wz;
+            EXPECT_NEAR(hit->point.y, Terrain::sample_surface(wx, wz, false).height, 1e-3f);
+            EXPECT_NEAR(hit->distance, 50.0f - hit->point.y, 1e-3f);
+        }
+    }
+    Terrain::cleanup();
+}
+
+TEST(RaycastTest, SlantedRaysFindTheFirstHit) {
+    const Vector3 start = Terrain::get_start_position();
+    Terrain::update(start);
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> offset(-60.0f, 60.0f);
+    std::uniform_real_distribution<float> angle(0.0f, 6.2831853f);
+    std::uniform_real_distribution<float> pitch(0.02f, 0.6f);
+    int32_t hits = 0;
+    for (int32_t i = 0; i < 300; ++i) {
+        const float x = start.x + offset(rng);
+        const float z = start.z + offset(rng);
+        const Vector3 origin = {x, Terrain::get_height(x, z) + 3.0f, z};
+        const float a = angle(rng);
+        const float p = pitch(rng);
+        const Vector3 dir = {std::cos(a) * std::cos(p), -std::sin(p), std::sin(a) * std::cos(p)};
+        const auto hit = Terrain::raycast(origin, dir, 300.0f);
+        if (hit) {
+            ++hits;
+            expect_first_hit(origin, dir, *hit);
+        }
+    }
+    // everything heads downhill into rolling terrain, so nearly every ray lands
+    EXPECT_GT(hits, 250);
+    Terrain::cleanup();
+}
+
+TEST(RaycastTest, MissesAndShortRays) {
+    const Vector3 start = Terrain::get_start_position();
+    Terrain::update(start);
+    EXPECT_FALSE(Terrain::raycast({start.x, 30.0f, start.z}, {0.0f, 1.0f, 0.0f}, 100.0f).has_value());
+    EXPECT_FALSE(Terrain::raycast({start.x, 30.0f, start.z}, {0.0f, -1.0f, 0.0f}, 5.0f).has_value());
+    Terrain::cleanup();
+}
+
+TEST(RaycastTest, FallsBackOutsideResidentChunks) {
+    // nothing streamed in here: the ray is answered from get_height
+    const Vector3 far = {5000.0f, 0.0f, 5000.0f};
+    const Vector3 origin = {far.x, Terrain::get_height(far.x, far.z) + 5.0f, far.z};
+    const Vector3 dir = {0.8f, -0.6f, 0.0f};
+    const auto hit = Terrain::raycast(origin, dir, 100.0f);
+    ASSERT_TRUE(hit.has_value());
+    expect_first_hit(origin, dir, *hit);
+    Terrain::cleanup();
+}
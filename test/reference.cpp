@@ -0,0 +1,209 @@
+#include "raymath.h"
+#include "terrain.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <vector>
+
+// frozen scalar implementation of the world generator. optimized replacements of the terrain
+// kernels (simd, specialization, caching) must reproduce it within the tolerances below.
+namespace Reference {
+
+constexpr float NOISE_SCALE = 0.05f;
+constexpr float TERRAIN_HEIGHT_SCALE = 7.0f;
+constexpr float ROAD_NOISE_SCALE = 0.003f;
+constexpr float ROAD_AMPLITUDE = 200.0f;
+
+float sample_perlin_noise(float x, float y, float z) {
+    const auto get_permutation = []() {
+        std::array<int32_t, 512> p;
+        std::iota(p.begin(), p.begin() + 256, 0);
+        std::shuffle(p.begin(), p.begin() + 256, std::default_random_engine(42));
+        std::copy(p.begin(), p.begin() + 256, p.begin() + 256);
+        return p;
+    };
+
+    const auto get_grad = [](int32_t hash, float x, float y, float z) {
+        const int32_t h = hash & 15;
+        const float u = h < 8 ? x : y;
+        const float v = h < 4 ? y : h == 12 || h == 14 ? x : z;
+        return ((h & 1) == 0 ? u : -u) + ((h & 2) == 0 ? v : -v);
+    };
+
+    static const auto p = get_permutation();
+    const auto fade = [](float t) { return t * t * t * (t * (t * 6 - 15) + 10); };
+    const auto lerp = [](float t, float a, float b) { return a + t * (b - a); };
+
+    const int32_t X = static_cast<int32_t>(std::floor(x)) & 255;
+    const int32_t Y = static_cast<int32_t>(std::floor(y)) & 255;
+    const int32_t Z = static_cast<int32_t>(std::floor(z)) & 255;
+
+    x -= std::floor(x);
+    y -= std::floor(y);
+    z -= std::floor(z);
+
+    const float u = fade(x), v = fade(y), w = fade(z);
+
+    const size_t idx_X = static_cast<size_t>(X);
+    const size_t idx_Y = static_cast<size_t>(Y);
+    const size_t idx_Z = static_cast<size_t>(Z);
+
+    const size_t A = static_cast<size_t>(p[idx_X]) + idx_Y;
+    const size_t AA = static_cast<size_t>(p[A]) + idx_Z;
+    const size_t AB = static_cast<size_t>(p[A + 1]) + idx_Z;
+    const size_t B = static_cast<size_t>(p[idx_X + 1]) + idx_Y;
+    const size_t BA = static_cast<size_t>(p[B]) + idx_Z;
+    const size_t BB = static_cast<size_t>(p[B + 1]) + idx_Z;
+
+    return lerp(w, lerp(v, lerp(u, get_grad(p[AA], x, y, z), get_grad(p[BA], x - 1, y, z)), lerp(u, get_grad(p[AB], x, y - 1, z), get_grad(p[BB], x - 1, y - 1, z))), lerp(v, lerp(u, get_grad(p[AA + 1], x, y, z - 1), get_grad(p[BA + 1], x - 1, y, z - 1)), lerp(u, get_grad(p[AB + 1], x, y - 1, z - 1), get_grad(p[BB + 1], x - 1, y - 1, z - 1))));
+}
+
+float get_height(float x, float z) { return sample_perlin_noise(x * NOISE_SCALE, 0.0f, z * NOISE_SCALE) * TERRAIN_HEIGHT_SCALE; }
+
+float get_road_center_x(float z) { return sample_perlin_noise(0.0f, 42.0f, z * ROAD_NOISE_SCALE) * ROAD_AMPLITUDE; }
+
+Vector3 get_normal(float x, float z) {
+    const float step = 0.1f;
+    const float height = get_height(x, z);
+    const Vector3 v1 = {step, get_height(x + step, z) - height, 0.0f};
+    const Vector3 v2 = {0.0f, get_height(x, z + step) - height, step};
+    return Vector3Normalize(Vector3CrossProduct(v2, v1));
+}
+
+Color get_color(int32_t x, int32_t z, float wx, float wz) {
+    const float dist = std::abs(wx - get_road_center_x(wz));
+    Color col = ((x + z) % 2 == 0) ? DARKGREEN : GREEN;
+    constexpr Color ROAD_COLOR = {30, 30, 30, 255};
+    if (dist < 6.0f) {
+        col = (dist < 4.0f) ? ROAD_COLOR : ColorLerp(ROAD_COLOR, col, (dist - 4.0f) / 2.0f);
+    }
+    return col;
+}
+
+} // namespace Reference
+
+namespace {
+
+// ulp budgets leave room for reassociation in vectorized kernels. near zero a ulp is meaningless,
+// so differences below the absolute floor (relative to the kernel's output scale) also pass.
+constexpr int64_t HEIGHT_MAX_ULPS = 4;
+constexpr float HEIGHT_ABS_FLOOR = 1e-5f;
+constexpr int64_t ROAD_MAX_ULPS = 4;
+constexpr float ROAD_ABS_FLOOR = 1e-4f;
+constexpr int64_t NORMAL_MAX_ULPS = 64;
+constexpr float NORMAL_ABS_FLOOR = 1e-5f;
+constexpr int32_t COLOR_MAX_DELTA = 1;
+
+constexpr int32_t RANDOM_SAMPLES = 1 << 20;
+
+int64_t ulp_distance(float a, float b) {
+    // map the sign-magnitude bit pattern onto a monotonic integer line
+    const auto ordered = [](float f) {
+        const auto bits = static_cast<int64_t>(std::bit_cast<int32_t>(f));
+        return bits < 0 ? std::numeric_limits<int32_t>::min() - bits : bits;
+    };
+    return std::abs(ordered(a) - ordered(b));
+}
+
+::testing::AssertionResult near_ulps(float actual, float expected, int64_t max_ulps, float abs_floor) {
+    if (ulp_distance(actual, expected) <= max_ulps || std::abs(actual - expected) <= abs_floor) {
+        return ::testing::AssertionSuccess();
+    }
+    return ::testing::AssertionFailure() << actual << " vs reference " << expected << " (" << ulp_distance(actual, expected) << " ulps)";
+}
+
+// negative coordinates, noise lattice boundaries (and their float neighbours), and huge values
+std::vector<float> edge_coordinates() {
+    std::vector<float> out = {0.0f, -0.0f, 1e-30f, -1e-30f, 1e6f, -1e6f, 1.6777216e7f, -1.6777216e7f, 1e9f, -1e9f};
+    for (int32_t k = -300; k <= 300; ++k) {
+        for (const float lattice : {static_cast<float>(k) / Reference::NOISE_SCALE, static_cast<float>(k) / Reference::ROAD_NOISE_SCALE, static_cast<float>(k * 256) / Reference::NOISE_SCALE}) {
+            out.push_back(lattice);
+            out.push_back(std::nextafter(lattice, -INFINITY));
+            out.push_back(std::nextafter(lattice, INFINITY));
+        }
+    }
+    return out;
+}
+
+std::vector<float> random_coordinates(uint32_t seed) {
+    std::mt19937 rng{seed};
+    std::uniform_real_distribution<float> near(-1000.0f, 1000.0f);
+    std::uniform_real_distribution<float> far(-1e7f, 1e7f);
+    std::vector<float> out(RANDOM_SAMPLES);
+    std::ranges::generate(out, [&] { return (rng() & 1) != 0 ? near(rng) : far(rng); });
+    return out;
+}
+
+} // namespace
+
+TEST(ReferenceTest, HeightMatchesOracle) {
+    const std::vector<float> edges = edge_coordinates();
+    for (const float x : edges) {
+        for (const float z : {0.0f, -17.5f, 20.0f, 1e6f}) {
+            ASSERT_TRUE(near_ulps(Terrain::get_height(x, z), Reference::get_height(x, z), HEIGHT_MAX_ULPS, HEIGHT_ABS_FLOOR)) << "x=" << x << " z=" << z;
+            ASSERT_TRUE(near_ulps(Terrain::get_height(z, x), Reference::get_height(z, x), HEIGHT_MAX_ULPS, HEIGHT_ABS_FLOOR)) << "x=" << z << " z=" << x;
+        }
+    }
+    const std::vector<float> xs = random_coordinates(1);
+    const std::vector<float> zs = random_coordinates(2);
+    for (size_t i = 0; i < xs.size(); ++i) {
+        ASSERT_TRUE(near_ulps(Terrain::get_height(xs[i], zs[i]), Reference::get_height(xs[i], zs[i]), HEIGHT_MAX_ULPS, HEIGHT_ABS_FLOOR)) << "x=" << xs[i] << " z=" << zs[i];
+    }
+}
+
+TEST(ReferenceTest, RoadCenterMatchesOracle) {
+    for (const float z : edge_coordinates()) {
+        ASSERT_TRUE(near_ulps(Terrain::get_road_center_x(z), Reference::get_road_center_x(z), ROAD_MAX_ULPS, ROAD_ABS_FLOOR)) << "z=" << z;
+    }
+    for (const float z : random_coordinates(3)) {
+        ASSERT_TRUE(near_ulps(Terrain::get_road_center_x(z), Reference::get_road_center_x(z), ROAD_MAX_ULPS, ROAD_ABS_FLOOR)) << "z=" << z;
+    }
+}
+
+TEST(ReferenceTest, ChunkMeshMatchesOracle) {
+    const float chunk_size = Terrain::get_chunk_size();
+    // window centers around the origin, across negative chunk indices and far from the origin
+    constexpr std::array<Vector2, 6> CENTERS = {{{0.0f, 0.0f}, {-100.0f, -100.0f}, {5000.0f, -8000.0f}, {-250000.0f, 125000.0f}, {1e6f, 1e6f}, {-4e6f, 3e6f}}};
+    for (const Vector2 center : CENTERS) {
+        Terrain::update({center.x, 0.0f, center.y});
+        const auto ccx = static_cast<int32_t>(std::floor(center.x / chunk_size));
+        const auto ccz = static_cast<int32_t>(std::floor(center.y / chunk_size));
+        for (int32_t cz = ccz - 2; cz <= ccz + 2; ++cz) {
+            for (int32_t cx = ccx - 2; cx <= ccx + 2; ++cx) {
+                const Mesh *mesh = Terrain::find_chunk_mesh(cx, cz);
+                ASSERT_NE(mesh, nullptr) << "chunk " << cx << "," << cz << " not resident";
+                const auto grid = static_cast<int32_t>(std::lround(std::sqrt(mesh->vertexCount)));
+                ASSERT_EQ(grid * grid, mesh->vertexCount);
+                const float tile = chunk_size / static_cast<float>(grid - 1);
+                for (int32_t z = 0; z < grid; ++z) {
+                    for (int32_t x = 0; x < grid; ++x) {
+                        const auto i = static_cast<size_t>(z * grid + x);
+                        const float wx = static_cast<float>(cx) * chunk_size + static_cast<float>(x) * tile;
+                        const float wz = static_cast<float>(cz) * chunk_size + static_cast<float>(z) * tile;
+                        ASSERT_TRUE(near_ulps(mesh->vertices[i * 3 + 1], Reference::get_height(wx, wz), HEIGHT_MAX_ULPS, HEIGHT_ABS_FLOOR)) << "height at " << wx << "," << wz;
+                        const Vector3 n = Reference::get_normal(wx, wz);
+                        ASSERT_TRUE(near_ulps(mesh->normals[i * 3], n.x, NORMAL_MAX_ULPS, NORMAL_ABS_FLOOR)) << "normal.x at " << wx << "," << wz;
+                        ASSERT_TRUE(near_ulps(mesh->normals[i * 3 + 1], n.y, NORMAL_MAX_ULPS, NORMAL_ABS_FLOOR)) << "normal.y at " << wx << "," << wz;
+                        ASSERT_TRUE(near_ulps(mesh->normals[i * 3 + 2], n.z, NORMAL_MAX_ULPS, NORMAL_ABS_FLOOR)) << "normal.z at " << wx << "," << wz;
+                        const Color c = Reference::get_color(x, z, wx, wz);
+                        const unsigned char *actual = &mesh->colors[i * 4];
+                        ASSERT_LE(std::abs(actual[0] - c.r), COLOR_MAX_DELTA) << "color at " << wx << "," << wz;
+                        ASSERT_LE(std::abs(actual[1] - c.g), COLOR_MAX_DELTA) << "color at " << wx << "," << wz;
+                        ASSERT_LE(std::abs(actual[2] - c.b), COLOR_MAX_DELTA) << "color at " << wx << "," << wz;
+                        ASSERT_EQ(actual[3], c.a) << "alpha at " << wx << "," << wz;
+                    }
+                }
+            }
+        }
+    }
+    Terrain::cleanup();
+}
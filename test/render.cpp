@@ -0,0 +1,157 @@
+#include "fog.hpp"
+#include "frustum.hpp"
+#include "horizon.hpp"
+#include "landscape.hpp"
+#include "raymath.h"
+#include "renderqueue.hpp"
+#include "scene.hpp"
+#include "terrain.hpp"
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+
+// renders fixed poses of the fixed-seed world offscreen and compares them with golden images.
+// meant for a gpu-less machine: `make render-test` runs it under xvfb with mesa's software rasterizer.
+// without a display it skips; UPDATE_GOLDEN=1 writes the goldens instead of comparing. a plain test run also skips
+// while no goldens are committed, `make render-test` sets REQUIRE_GOLDEN=1 so a missing golden fails there.
+
+namespace {
+
+constexpr int32_t WIDTH = 320;
+constexpr int32_t HEIGHT = 180;
+constexpr int32_t CHANNEL_TOLERANCE = 16;   // per channel: driver rounding and dithering stay below it
+constexpr double MISMATCH_TOLERANCE = 0.01; // fraction of pixels allowed past the channel tolerance
+constexpr int32_t LANDSCAPE_UPDATES = 60;   // spawn attempts are batched per update, so this fixes the population
+
+struct Pose {
+    std::string_view name;
+    Vector3 offset; // eye relative to the start position
+    Vector3 look;   // target relative to the start position
+};
+
+constexpr std::array<Pose, 4> POSES = {{
+    {"chase", {0.0f, 8.0f, -15.0f}, {0.0f, 0.0f, 0.0f}},
+    {"ahead", {0.0f, 4.0f, 5.0f}, {0.0f, 2.0f, 60.0f}},
+    {"side", {40.0f, 12.0f, 10.0f}, {0.0f, 0.0f, 10.0f}},
+    {"above", {0.0f, 90.0f, 1.0f}, {0.0f, 0.0f, 0.0f}},
+}};
+
+const std::filesystem::path GOLDEN_DIRECTORY = std::filesystem::path(__FILE__).parent_path() / "golden";
+
+struct Frame {
+    Image image; // top-down rgba
+    double ms;
+};
+
+// draws one frame into the target and reads it back; the read back waits for the driver, so the time includes rasterization
+Frame render_pose(const RenderTexture2D &target, const Camera3D &camera) {
+    const auto start = std::chrono::steady_clock::now();
+    const std::array views = {Frustum::from_camera(camera, static_cast<float>(target.texture.width) / static_cast<float>(target.texture.height))};
+    BeginTextureMode(target);
+    Scene::draw(camera, views);
+    EndTextureMode();
+    Image image = LoadImageFromTexture(target.texture);
+    const auto end = std::chrono::steady_clock::now();
+    ImageFlipVertical(&image);
+    ImageFormat(&image, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+    return {.image = image, .ms = std::chrono::duration<double, std::milli>(end - start).count()};
+}
+
+double get_mismatch(const Image &actual, const Image &golden) {
+    const auto *a = static_cast<const uint8_t *>(actual.data);
+    const auto *g = static_cast<const uint8_t *>(golden.data);
+    int32_t mismatched = 0;
+    for (int32_t i = 0; i < WIDTH * HEIGHT; ++i) {
+        for (int32_t c = 0; c < 3; ++c) {
+            const auto index = static_cast<size_t>(i * 4 + c);
+            if (std::abs(static_cast<int32_t>(a[index]) - static_cast<int32_t>(g[index])) > CHANNEL_TOLERANCE) {
+                ++mismatched;
+                break;
+            }
+        }
+    }
+    return static_cast<double>(mismatched) / (WIDTH * HEIGHT);
+}
+
+} // namespace
+
+TEST(RenderTest, PosesMatchGoldenImages) {
+    if (std::getenv("DISPLAY") == nullptr) {
+        GTEST_SKIP() << "no display; run under xvfb-run";
+    }
+    const bool update_golden = std::getenv("UPDATE_GOLDEN") != nullptr;
+    if (!update_golden && std::getenv("REQUIRE_GOLDEN") == nullptr && !std::filesystem::exists(GOLDEN_DIRECTORY)) {
+        GTEST_SKIP() << GOLDEN_DIRECTORY << " is missing; run `UPDATE_GOLDEN=1 make render-test` and commit it";
+    }
+    SetConfigFlags(FLAG_WINDOW_HIDDEN);
+    SetTraceLogLevel(LOG_WARNING);
+    InitWindow(WIDTH, HEIGHT, "render test");
+    ASSERT_TRUE(IsWindowReady());
+
+    const Vector3 start = Terrain::get_start_position();
+    Fog::configure(Terrain::get_view_distance());
+    RenderQueue::set_shader(RenderQueue::State::BATCH, Fog::get_shader());
+    Terrain::update(start);
+    for (int32_t i = 0; i < LANDSCAPE_UPDATES; ++i) {
+        Landscape::update(start);
+    }
+    const RenderTexture2D target = LoadRenderTexture(WIDTH, HEIGHT);
+    if (update_golden) {
+        std::filesystem::create_directories(GOLDEN_DIRECTORY);
+    }
+
+    for (const Pose &pose : POSES) {
+        const Camera3D camera = {
+            .position = Vector3Add(start, pose.offset),
+            .target = Vector3Add(start, pose.look),
+            .up = {0.0f, 1.0f, 0.0f},
+            .fovy = 45.0f,
+            .projection = CAMERA_PERSPECTIVE,
+        };
+        Horizon::update(camera.position);
+        const auto [actual, ms] = render_pose(target, camera);
+        RecordProperty(std::string(pose.name) + "_ms", std::to_string(ms));
+        std::printf("%-6s %8.2f ms\n", std::string(pose.name).c_str(), ms);
+
+        const std::string path = (GOLDEN_DIRECTORY / (std::string(pose.name) + ".png")).string();
+        if (update_golden) {
+            EXPECT_TRUE(ExportImage(actual, path.c_str())) << path;
+            std::printf("%-6s wrote %s\n", std::string(pose.name).c_str(), path.c_str());
+            UnloadImage(actual);
+            continue;
+        }
+        // blessing whatever this machine draws would compare nothing: goldens come from llvmpipe and are committed
+        if (!std::filesystem::exists(path)) {
+            ADD_FAILURE() << path << " is missing; run `UPDATE_GOLDEN=1 make render-test` and commit it";
+            UnloadImage(actual);
+            continue;
+        }
+        Image golden = LoadImage(path.c_str());
+        ImageFormat(&golden, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+        ASSERT_EQ(golden.width, WIDTH) << path;
+        ASSERT_EQ(golden.height, HEIGHT) << path;
+        const double mismatch = get_mismatch(actual, golden);
+        EXPECT_LE(mismatch, MISMATCH_TOLERANCE) << pose.name << ": " << mismatch * 100.0 << "% of pixels differ";
+        if (mismatch > MISMATCH_TOLERANCE) {
+            const std::string diff_path = (std::filesystem::temp_directory_path() / (std::string(pose.name) + "_actual.png")).string();
+            ExportImage(actual, diff_path.c_str());
+            std::printf("%-6s actual saved to %s\n", std::string(pose.name).c_str(), diff_path.c_str());
+        }
+        UnloadImage(golden);
+        UnloadImage(actual);
+    }
+
+    UnloadRenderTexture(target);
+    Landscape::cleanup();
+    Horizon::cleanup();
+    Terrain::cleanup();
+    Fog::cleanup();
+    CloseWindow();
+}
@@ -0,0 +1,115 @@
+#include "renderqueue.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace {
+
+std::vector<int> drawn;
+
+template <int ID> void record(const Camera3D &) { drawn.push_back(ID); }
+
+const Camera3D camera = {.position = {0.0f, 0.0f, 0.0f}, .target = {0.0f, 0.0f, 1.0f}, .up = {0.0f, 1.0f, 0.0f}, .fovy = 60.0f, .projection = CAMERA_PERSPECTIVE};
+
+} // namespace
+
+TEST(RenderQueueTest, SortsPassesAndDepth) {
+    using RenderQueue::Pass;
+    using RenderQueue::State;
+    drawn.clear();
+    RenderQueue::begin(camera);
+    RenderQueue::submit_custom(Pass::TRANSPARENT, State::BATCH, {0.0f, 0.0f, 5.0f}, record<6>);
+    RenderQueue::submit_custom(Pass::OPAQUE, State::BATCH, {0.0f, 0.0f, 30.0f}, record<4>);
+    RenderQueue::submit_custom(Pass::BACKGROUND, State::HORIZON, {0.0f, 0.0f, 0.0f}, record<1>);
+    RenderQueue::submit_custom(Pass::OPAQUE, State::BATCH, {0.0f, 0.0f, 3.0f}, record<3>);
+    RenderQueue::submit_custom(Pass::TRANSPARENT, State::BATCH, {0.0f, 0.0f, 50.0f}, record<5>);
+    RenderQueue::submit_custom(Pass::BACKGROUND, State::HORIZON, {0.0f, 0.0f, 900.0f}, record<2>);
+    RenderQueue::flush();
+    // background keeps submission order, opaque runs front to back, transparent back to front
+    EXPECT_EQ(drawn, (std::vector<int>{1, 2, 3, 4, 5, 6}));
+}
+
+TEST(RenderQueueTest, GroupsStatesWithinAPass) {
+    using RenderQueue::Pass;
+    using RenderQueue::State;
+    drawn.clear();
+    RenderQueue::begin(camera);
+    for (int i = 0; i < 4; ++i) {
+        const float depth = static_cast<float>(i);
+        RenderQueue::submit_custom(Pass::OPAQUE, State::BATCH, {0.0f, 0.0f, depth}, record<0>);
+        RenderQueue::submit_custom(Pass::OPAQUE, State::TERRAIN, {0.0f, 0.0f, depth}, record<1>);
+    }
+    RenderQueue::flush();
+    EXPECT_EQ(drawn, (std::vector<int>{1, 1, 1, 1, 0, 0, 0, 0}));
+    const RenderQueue::Stats stats = RenderQueue::get_stats();
+    EXPECT_EQ(stats.items, 8);
+    EXPECT_EQ(stats.submitted_state_changes, 8);
+    EXPECT_EQ(stats.sorted_state_changes, 2);
+}
+
+TEST(RenderQueueTest, TransparentStatesStayBackToFront) {
+    using RenderQueue::Pass;
+    using RenderQueue::State;
+    drawn.clear();
+    RenderQueue::begin(camera);
+    // sky glow and clouds seen through the car's tinted glass: depth decides, whatever the state
+    RenderQueue::submit_custom(Pass::TRANSPARENT, State::BATCH, {0.0f, 0.0f, 2.0f}, record<4>);
+    RenderQueue::submit_custom(Pass::TRANSPARENT, State::SKY, {0.0f, 0.0f, 400.0f}, record<2>);
+    RenderQueue::submit_custom(Pass::TRANSPARENT, State::BATCH, {0.0f, 0.0f, 900.0f}, record<1>);
+    RenderQueue::submit_custom(Pass::TRANSPARENT, State::SKY, {0.0f, 0.0f, 20.0f}, record<3>);
+    RenderQueue::submit_custom(Pass::TRANSPARENT, State::SKY, {0.0f, 0.0f, 2.0f}, record<5>);
+    RenderQueue::flush();
+    // at equal depth the state breaks the tie
+    EXPECT_EQ(drawn, (std::vector<int>{1, 2, 3, 4, 5}));
+    EXPECT_EQ(RenderQueue::get_stats().sorted_state_changes, 4);
+}
+
+TEST(RenderQueueTest, PrimitivesFollowAlpha) {
+    RenderQueue::begin(camera);
+    RenderQueue::submit_sphere({0.0f, 0.0f, 10.0f}, 1.0f, {255, 255, 255, 255});
+    RenderQueue::submit_sphere({0.0f, 0.0f, 20.0f}, 1.0f, {255, 255, 255, 128});
+    RenderQueue::submit_sphere({0.0f, 0.0f, 30.0f}, 1.0f, {255, 255, 255, 255});
+    RenderQueue::flush();
+    EXPECT_EQ(RenderQueue::get_stats().sorted_state_changes, 2);
+}
+
+TEST(RenderQueueTest, ReplaySortsForTheNewCamera) {
+    using RenderQueue::Pass;
+    using RenderQueue::State;
+    drawn.clear();
+    RenderQueue::begin(camera);
+    RenderQueue::submit_custom(Pass::OPAQUE, State::BATCH, {0.0f, 0.0f, 10.0f}, record<1>);
+    RenderQueue::submit_custom(Pass::OPAQUE, State::BATCH, {0.0f, 0.0f, -10.0f}, record<2>);
+    RenderQueue::submit_custom(Pass::TRANSPARENT, State::BATCH, {0.0f, 0.0f, 20.0f}, record<3>);
+    RenderQueue::submit_custom(Pass::TRANSPARENT, State::BATCH, {0.0f, 0.0f, -20.0f}, record<4>);
+    RenderQueue::flush();
+    const RenderQueue::Stats stats = RenderQueue::get_stats();
+
+    // from behind, near and far swap for both passes, and nothing has to be submitted again
+    Camera3D rear = camera;
+    rear.position = {0.0f, 0.0f, -15.0f};
+    RenderQueue::replay(rear);
+    EXPECT_EQ(drawn, (std::vector<int>{1, 2, 3, 4, 2, 1, 3, 4}));
+    EXPECT_EQ(RenderQueue::get_stats().items, stats.items);
+}
+
+TEST(RenderQueueTest, DropsItemsPastCapacity) {
+    RenderQueue::begin(camera);
+    constexpr int32_t SUBMITTED = 20000;
+    for (int32_t i = 0; i < SUBMITTED; ++i) {
+        RenderQueue::submit_sphere({0.0f, 0.0f, static_cast<float>(i)}, 1.0f, GREEN);
+    }
+    RenderQueue::flush();
+    const RenderQueue::Stats stats = RenderQueue::get_stats();
+    EXPECT_GT(stats.dropped, 0);
+    EXPECT_EQ(stats.items + stats.dropped, SUBMITTED);
+
+    // the next frame starts with a full queue again
+    RenderQueue::begin(camera);
+    RenderQueue::submit_sphere({0.0f, 0.0f, 1.0f}, 1.0f, GREEN);
+    RenderQueue::flush();
+    EXPECT_EQ(RenderQueue::get_stats().items, 1);
+    EXPECT_EQ(RenderQueue::get_stats().dropped, 0);
+}
@@ -0,0 +1,54 @@
+#include "resolution.hpp"
+
+#include <gtest/gtest.h>
+
+TEST(ResolutionTest, ScaleFollowsFrameBudget) {
+    Resolution::cleanup();
+    Resolution::set_budget(1.0f / 60.0f);
+    EXPECT_FLOAT_EQ(Resolution::get_scale(), 1.0f);
+
+    // a fill-bound 30 fps pushes resolution down to the floor, never below it
+    float scale = 1.0f;
+    for (int i = 0; i < 300; ++i) {
+        const float next = Resolution::update(1.0f / 30.0f);
+        EXPECT_LE(next, scale);
+        scale = next;
+    }
+    EXPECT_FLOAT_EQ(scale, 0.5f);
+
+    // frames well under budget bring it back to native, never above it
+    for (int i = 0; i < 300; ++i) {
+        const float next = Resolution::update(1.0f / 120.0f);
+        EXPECT_GE(next, scale);
+        scale = next;
+    }
+    EXPECT_FLOAT_EQ(scale, 1.0f);
+}
+
+TEST(ResolutionTest, HoldsScaleInsideDeadBand) {
+    Resolution::cleanup();
+    Resolution::set_budget(1.0f / 60.0f);
+    for (int i = 0; i < 8; ++i) {
+        Resolution::update(1.0f / 30.0f);
+    }
+    const float settled = Resolution::get_scale();
+    ASSERT_LT(settled, 1.0f);
+    ASSERT_GT(settled, 0.5f);
+    // a frame time between the headroom and the budget converges the average without touching the scale
+    for (int i = 0; i < 200; ++i) {
+        Resolution::update(0.93f / 60.0f);
+    }
+    const float held = Resolution::get_scale();
+    for (int i = 0; i < 200; ++i) {
+        EXPECT_FLOAT_EQ(Resolution::update(0.93f / 60.0f), held);
+    }
+}
+
+TEST(ResolutionTest, HeadlessBeginEndIsNoOp) {
+    Resolution::cleanup();
+    Resolution::begin();
+    Resolution::end();
+    Resolution::begin();
+    Resolution::end();
+    Resolution::cleanup();
+}
@@ -0,0 +1,196 @@
+#include "camera.hpp"
+#include "car.hpp"
+#include "landscape.hpp"
+#include "snapshot.hpp"
+#include "terrain.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace {
+
+// each test writes its own file, so parallel runs can't read each other's snapshots
+std::filesystem::path temp_snapshot_path() {
+    const std::string test = ::testing::UnitTest::GetInstance()->current_test_info()->name();
+    return std::filesystem::temp_directory_path() / ("silly_roads_" + test + ".snapshot");
+}
+
+std::vector<Vector3> get_element_positions() {
+    std::vector<Vector3> positions;
+    for (int32_t i = 0; i < Landscape::get_count(); ++i) {
+        positions.push_back(Landscape::get_position(i));
+    }
+    return positions;
+}
+
+bool same_positions(const std::vector<Vector3> &a, const std::vector<Vector3> &b) {
+    return std::ranges::equal(a, b, [](const Vector3 &p, const Vector3 &q) { return p.x == q.x && p.y == q.y && p.z == q.z; });
+}
+
+// advances the world a frame the way the main loop does
+void step(float dt) {
+    Cam::update(dt);
+    Terrain::update(Car::get_position());
+    Landscape::update(Car::get_position());
+    Car::update(dt);
+}
+
+} // namespace
+
+TEST(SnapshotTest, RestoresTheSavedWorld) {
+    const std::filesystem::path path = temp_snapshot_path();
+    for (int32_t i = 0; i < 30; ++i) {
+        step(1.0f / 60.0f);
+    }
+    ASSERT_TRUE(Snapshot::save(path.string()));
+    const Vector3 car = Car::get_position();
+    const float heading = Car::get_heading();
+    const Camera3D camera = Cam::get_cameras()[0];
+    const std::vector<Vector3> elements = get_element_positions();
+    const int32_t chunks = Terrain::get_resident_count();
+    const int32_t cx = static_cast<int32_t>(std::floor(car.x / Terrain::get_chunk_size()));
+    const int32_t cz = static_cast<int32_t>(std::floor(car.z / Terrain::get_chunk_size()));
+    const auto n = static_cast<size_t>(Terrain::get_chunk_resolution() * Terrain::get_chunk_resolution());
+    const Mesh *saved = Terrain::find_chunk_mesh(cx, cz);
+    ASSERT_NE(saved, nullptr);
+    const std::vector<float> vertices(saved->vertices, saved->vertices + n * 3);
+    const std::vector<float> normals(saved->normals, saved->normals + n * 3);
+    const std::vector<unsigned char> colors(saved->colors, saved->colors + n * 4);
+
+    // what the saved session spawns next
+    step(1.0f / 60.0f);
+    const std::vector<Vector3> next_elements = get_element_positions();
+
+    // move on and drop everything, then resume
+    for (int32_t i = 0; i < 60; ++i) {
+        step(1.0f / 60.0f);
+    }
+    Landscape::cleanup();
+    Terrain::cleanup();
+    ASSERT_TRUE(Snapshot::load(path.string()));
+
+    EXPECT_EQ(Car::get_position().x, car.x);
+    EXPECT_EQ(Car::get_position().y, car.y);
+    EXPECT_EQ(Car::get_position().z, car.z);
+    EXPECT_EQ(Car::get_heading(), heading);
+    EXPECT_EQ(Cam::get_cameras()[0].position.y, camera.position.y);
+    EXPECT_EQ(Terrain::get_resident_count(), chunks);
+    EXPECT_TRUE(same_positions(get_element_positions(), elements));
+
+    const Mesh *restored = Terrain::find_chunk_mesh(cx, cz);
+    ASSERT_NE(restored, nullptr);
+    EXPECT_TRUE(std::equal(vertices.begin(), vertices.end(), restored->vertices));
+    EXPECT_TRUE(std::equal(colors.begin(), colors.end(), restored->colors));
+    for (size_t i = 0; i < normals.size(); ++i) {
+        ASSERT_NEAR(restored->normals[i], normals[i], 0.02f) << i;
+    }
+    // raycasts and height queries answer from the restored chunks without regenerating them
+    const auto hit = Terrain::raycast({car.x, car.y + 20.0f, car.z}, {0.0f, -1.0f, 0.0f}, 100.0f);
+    ASSERT_TRUE(hit.has_value());
+    EXPECT_NEAR(hit->point.y, Terrain::sample_surface(car.x, car.z, false).height, 0.1f);
+
+    // the next frame keeps every restored chunk and continues the saved spawn sequence
+    step(1.0f / 60.0f);
+    EXPECT_EQ(Terrain::find_chunk_mesh(cx, cz), restored);
+    EXPECT_EQ(Terrain::get_resident_count(), chunks);
+    EXPECT_TRUE(same_positions(get_element_positions(), next_elements));
+
+    Landscape::cleanup();
+    Terrain::cleanup();
+    std::filesystem::remove(path);
+}
+
+TEST(SnapshotTest, RejectsMissingAndDamagedFiles) {
+    const std::filesystem::path path = temp_snapshot_path();
+    std::filesystem::remove(path);
+    EXPECT_FALSE(Snapshot::load(path.string()));
+
+    Terrain::update(Terrain::get_start_position());
+    for (int32_t i = 0; i < 50; ++i) {
+        Landscape::update(Terrain::get_start_position());
+    }
+    ASSERT_TRUE(Snapshot::save(path.string()));
+    const std::vector<Vector3> elements = get_element_positions();
+    const int32_t chunks = Terrain::get_resident_count();
+
+    // one flipped byte in the payload fails the checksum and leaves the world untouched
+    {
+        std::FILE *file = std::fopen(path.string().c_str(), "r+b");
+        ASSERT_NE(file, nullptr);
+        std::fseek(file, 1000, SEEK_SET);
+        const int c = std::fgetc(file);
+        std::fseek(file, 1000, SEEK_SET);
+        std::fputc(c ^ 0x40, file);
+        std::fclose(file);
+    }
+    EXPECT_FALSE(Snapshot::load(path.string()));
+    EXPECT_EQ(Terrain::get_resident_count(), chunks);
+    EXPECT_TRUE(same_positions(get_element_positions(), elements));
+
+    ASSERT_TRUE(Snapshot::save(path.string()));
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 1);
+    EXPECT_FALSE(Snapshot::load(path.string()));
+
+    Landscape::cleanup();
+    Terrain::cleanup();
+    std::filesystem::remove(path);
+}
+
+TEST(SnapshotTest, MalformedLaterSectionChangesNothing) {
+    const std::filesystem::path path = temp_snapshot_path();
+    Terrain::update(Terrain::get_start_position());
+    for (int32_t i = 0; i < 50; ++i) {
+        Landscape::update(Terrain::get_start_position());
+    }
+    ASSERT_TRUE(Snapshot::save(path.string()));
+    EXPECT_FALSE(std::filesystem::exists(path.string() + ".tmp"));
+
+    // drop the last payload byte (inside the landscape section) and reseal the header, so only the section check fails
+    std::vector<std::byte> bytes(std::filesystem::file_size(path));
+    {
+        std::FILE *file = std::fopen(path.string().c_str(), "rb");
+        ASSERT_NE(file, nullptr);
+        ASSERT_EQ(std::fread(bytes.data(), 1, bytes.size(), file), bytes.size());
+        std::fclose(file);
+    }
+    bytes.pop_back();
+    constexpr size_t HEADER_SIZE = 32;
+    const uint64_t payload_size = bytes.size() - HEADER_SIZE;
+    uint64_t checksum = 14695981039346656037ull;
+    for (size_t i = HEADER_SIZE; i < bytes.size(); ++i) {
+        checksum = (checksum ^ static_cast<uint64_t>(bytes[i])) * 1099511628211ull;
+    }
+    std::memcpy(bytes.data() + 16, &payload_size, sizeof(payload_size));
+    std::memcpy(bytes.data() + 24, &checksum, sizeof(checksum));
+    {
+        std::FILE *file = std::fopen(path.string().c_str(), "wb");
+        ASSERT_NE(file, nullptr);
+        ASSERT_EQ(std::fwrite(bytes.data(), 1, bytes.size(), file), bytes.size());
+        std::fclose(file);
+    }
+
+    // the car and chunks sections before it are fine, but neither is applied
+    for (int32_t i = 0; i < 30; ++i) {
+        step(1.0f / 60.0f);
+    }
+    const Vector3 car = Car::get_position();
+    const int32_t chunks = Terrain::get_resident_count();
+    const std::vector<Vector3> elements = get_element_positions();
+    EXPECT_FALSE(Snapshot::load(path.string()));
+    EXPECT_EQ(Car::get_position().x, car.x);
+    EXPECT_EQ(Car::get_position().z, car.z);
+    EXPECT_EQ(Terrain::get_resident_count(), chunks);
+    EXPECT_TRUE(same_positions(get_element_positions(), elements));
+
+    Landscape::cleanup();
+    Terrain::cleanup();
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,111 @@
+#include "car.hpp"
+#include "frustum.hpp"
+#include "landscape.hpp"
+#include "renderqueue.hpp"
+#include "terrain.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <span>
+
+namespace {
+
+constexpr float ASPECT = 16.0f / 9.0f;
+
+Camera3D chase_camera(const Vector3 &car) {
+    return {
+        .position = {car.x, car.y + 8.0f, car.z - 15.0f},
+        .target = car,
+        .up = {0.0f, 1.0f, 0.0f},
+        .fovy = 45.0f,
+        .projection = CAMERA_PERSPECTIVE,
+    };
+}
+
+// headless frames of `players` cars driving side by side: streaming once, then culling and queueing per view;
+// returns the most chunks resident at once
+int32_t drive(int32_t players, float start_z) {
+    constexpr float DT = 1.0f / 60.0f;
+    constexpr float SPEED = 50.0f;
+    constexpr std::array<float, 2> LANES = {1.5f, -1.5f};
+    Car::set_player_count(players);
+    int32_t max_resident = 0;
+    float z = start_z;
+    for (int32_t frame = 0; frame < 240; ++frame) {
+        z += SPEED * DT;
+        std::array<Terrain::Focus, 2> foci = {};
+        std::array<Camera3D, 2> cameras = {};
+        for (int32_t player = 0; player < players; ++player) {
+            const auto p = static_cast<size_t>(player);
+            const float x = Terrain::get_road_center_x(z) + LANES[p];
+            foci[p] = {.position = {x, Terrain::get_height(x, z), z}, .priority = 1};
+            cameras[p] = chase_camera(foci[p].position);
+        }
+        const auto active = std::span(foci.data(), static_cast<size_t>(players));
+        Terrain::update(active);
+        Landscape::update(active);
+        for (int32_t player = 0; player < players; ++player) {
+            const Camera3D &camera = cameras[static_cast<size_t>(player)];
+            const std::array views = {Frustum::from_camera(camera, ASPECT)};
+            RenderQueue::begin(camera);
+            RenderQueue::submit_custom(RenderQueue::Pass::OPAQUE, RenderQueue::State::TERRAIN, camera.position, Terrain::draw);
+            Landscape::draw(views);
+            Car::draw();
+            RenderQueue::flush();
+        }
+        max_resident = std::max(max_resident, Terrain::get_resident_count());
+    }
+    Landscape::cleanup();
+    Terrain::cleanup();
+    Car::set_player_count(1);
+    return max_resident;
+}
+
+} // namespace
+
+TEST(SplitScreenTest, FrustumKeepsWhatTheViewSees) {
+    const Camera3D camera = {.position = {0.0f, 0.0f, 0.0f}, .target = {0.0f, 0.0f, 1.0f}, .up = {0.0f, 1.0f, 0.0f}, .fovy = 45.0f, .projection = CAMERA_PERSPECTIVE};
+    const Frustum::Volume view = Frustum::from_camera(camera, ASPECT);
+    EXPECT_TRUE(Frustum::intersects_sphere(view, {0.0f, 0.0f, 10.0f}, 0.5f));
+    EXPECT_FALSE(Frustum::intersects_sphere(view, {0.0f, 0.0f, -10.0f}, 0.5f));
+    // 45 degrees vertically, about 72 horizontally at 16:9
+    EXPECT_TRUE(Frustum::intersects_sphere(view, {6.0f, 0.0f, 10.0f}, 0.5f));
+    EXPECT_FALSE(Frustum::intersects_sphere(view, {9.0f, 0.0f, 10.0f}, 0.5f));
+    EXPECT_FALSE(Frustum::intersects_sphere(view, {0.0f, 6.0f, 10.0f}, 0.5f));
+    // a large sphere reaching in from the side still counts
+    EXPECT_TRUE(Frustum::intersects_sphere(view, {12.0f, 0.0f, 10.0f}, 8.0f));
+}
+
+TEST(SplitScreenTest, LandscapeIsCulledPerView) {
+    const Vector3 start = Terrain::get_start_position();
+    for (int32_t i = 0; i < 300; ++i) {
+        Landscape::update(start);
+    }
+    const Camera3D forward = chase_camera(start);
+    Camera3D backward = forward;
+    backward.target = {start.x, start.y, start.z - 30.0f};
+    const std::array front_view = {Frustum::from_camera(forward, ASPECT)};
+    const std::array both_views = {Frustum::from_camera(forward, ASPECT), Frustum::from_camera(backward, ASPECT)};
+    RenderQueue::begin(forward);
+    Landscape::draw(front_view);
+    const int32_t front = Landscape::get_drawn_count();
+    Landscape::draw(both_views);
+    const int32_t both = Landscape::get_drawn_count();
+    EXPECT_GT(front, 0);
+    EXPECT_LT(front, Landscape::get_count() / 2);
+    EXPECT_GT(both, front);
+    Landscape::cleanup();
+    Terrain::cleanup();
+}
+
+TEST(SplitScreenTest, NeighbouringLanesShareTheWindow) {
+    // different stretches of road, so neither run finds the other's chunks in the height cache
+    const int32_t single = drive(1, 0.0f);
+    const int32_t split = drive(2, 20000.0f);
+    // at most one extra column or row; the frame cost of the second view is timed in the perf suite
+    EXPECT_LE(split, single + 5);
+}
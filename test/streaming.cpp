@@ -0,0 +1,110 @@
+#include "landscape.hpp"
+#include "terrain.hpp"
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+
+namespace {
+
+bool is_resident_around(const Vector3 &position, int32_t radius) {
+    const float size = Terrain::get_chunk_size();
+    const int32_t cx = static_cast<int32_t>(std::floor(position.x / size));
+    const int32_t cz = static_cast<int32_t>(std::floor(position.z / size));
+    for (int32_t z = -radius; z <= radius; ++z) {
+        for (int32_t x = -radius; x <= radius; ++x) {
+            if (Terrain::find_chunk_mesh(cx + x, cz + z) == nullptr) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+TEST(StreamingTest, OverlappingWindowsAreShared) {
+    const float size = Terrain::get_chunk_size();
+    const Vector3 a = {size * 0.5f, 0.0f, size * 0.5f};
+    Terrain::update(a);
+    const int32_t window = Terrain::get_resident_count();
+    EXPECT_EQ(window, 25);
+
+    // two viewpoints in one chunk hold exactly one window
+    const std::array same = {Terrain::Focus{a, 1}, Terrain::Focus{{a.x + 1.0f, 0.0f, a.z}, 0}};
+    Terrain::update(same);
+    EXPECT_EQ(Terrain::get_resident_count(), window);
+
+    // one chunk apart, the windows share four of their five columns
+    const std::array neighbours = {Terrain::Focus{a, 1}, Terrain::Focus{{a.x + size, 0.0f, a.z}, 0}};
+    Terrain::update(neighbours);
+    EXPECT_EQ(Terrain::get_resident_count(), window + 5);
+
+    // far apart, both windows are complete
+    const std::array apart = {Terrain::Focus{a, 1}, Terrain::Focus{{a.x + size * 20.0f, 0.0f, a.z}, 0}};
+    Terrain::update(apart);
+    EXPECT_EQ(Terrain::get_resident_count(), window * 2);
+    EXPECT_TRUE(is_resident_around(apart[0].position, 2));
+    EXPECT_TRUE(is_resident_around(apart[1].position, 2));
+    Terrain::cleanup();
+}
+
+TEST(StreamingTest, MemoryCapDropsTheLowestPriorityFirst) {
+    const float size = Terrain::get_chunk_size();
+    Terrain::update({size * 0.5f, 0.0f, size * 0.5f});
+    const size_t chunk_bytes = Terrain::get_resident_bytes() / static_cast<size_t>(Terrain::get_resident_count());
+    Terrain::cleanup();
+
+    const Vector3 player = {size * 0.5f, 0.0f, size * 0.5f};
+    const Vector3 cluster = {size * 30.5f, 0.0f, size * 0.5f};
+    Terrain::set_memory_cap(chunk_bytes * 34);
+    // the low priority focus is listed first: order must not matter
+    const std::array foci = {Terrain::Focus{cluster, 0}, Terrain::Focus{player, 5}};
+    Terrain::update(foci);
+    EXPECT_LE(Terrain::get_resident_bytes(), chunk_bytes * 34);
+    EXPECT_EQ(Terrain::get_resident_count(), 34);
+    EXPECT_TRUE(is_resident_around(player, 2));
+    // what is left goes to the center and inner ring of the cluster
+    EXPECT_TRUE(is_resident_around(cluster, 1));
+    EXPECT_FALSE(is_resident_around(cluster, 2));
+
+    // the same selection every frame: nothing is evicted and regenerated
+    const Mesh *center = Terrain::find_chunk_mesh(30, 0);
+    for (int32_t frame = 0; frame < 10; ++frame) {
+        Terrain::update(foci);
+        EXPECT_EQ(Terrain::find_chunk_mesh(30, 0), center);
+    }
+    Terrain::set_memory_cap(SIZE_MAX);
+    Terrain::cleanup();
+}
+
+TEST(StreamingTest, LandscapeFollowsEveryFocus) {
+    const Vector3 a = Terrain::get_start_position();
+    const Vector3 b = {a.x + 1000.0f, a.y, a.z};
+    for (int32_t i = 0; i < 300; ++i) {
+        Landscape::update(a);
+    }
+    const int32_t single = Landscape::get_count();
+
+    // the same focus twice spawns into the same disc: elements are shared, not doubled
+    const std::array twice = {Terrain::Focus{a, 1}, Terrain::Focus{a, 0}};
+    Landscape::update(twice);
+    EXPECT_LE(Landscape::get_count(), single + 10);
+
+    const std::array both = {Terrain::Focus{a, 1}, Terrain::Focus{b, 0}};
+    for (int32_t i = 0; i < 300; ++i) {
+        Landscape::update(both);
+    }
+    int32_t near_a = 0;
+    int32_t near_b = 0;
+    for (int32_t i = 0; i < Landscape::get_count(); ++i) {
+        const Vector3 p = Landscape::get_position(i);
+        (std::abs(p.x - a.x) < std::abs(p.x - b.x) ? near_a : near_b) += 1;
+    }
+    EXPECT_GE(near_a, single);
+    EXPECT_GT(near_b, single / 2);
+    Landscape::cleanup();
+    Terrain::cleanup();
+}
@@ -0,0 +1,74 @@
+#include "terrain.hpp"
+#include "traffic.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+
+TEST(TrafficTest, CarsFollowTheirLaneOnTheGround) {
+    const Vector3 center = Terrain::get_start_position();
+    Traffic::spawn(300, center);
+    for (int32_t step = 0; step < 120; ++step) {
+        Traffic::update(1.0f / 60.0f, center);
+    }
+    ASSERT_EQ(Traffic::get_count(), 300);
+    for (int32_t i = 0; i < Traffic::get_count(); ++i) {
+        const Vector3 p = Traffic::get_position(i);
+        EXPECT_NEAR(p.x, Terrain::get_road_center_x(p.z) + Traffic::get_lane(i), 1e-4f) << i;
+        EXPECT_FLOAT_EQ(p.y, Terrain::get_height(p.x, p.z)) << i;
+        // right-hand traffic: the -x lane drives towards +z
+        const float forward_z = std::cos(Traffic::get_heading(i));
+        EXPECT_EQ(forward_z > 0.0f, Traffic::get_lane(i) < 0.0f) << i;
+    }
+    Traffic::cleanup();
+    Terrain::cleanup();
+}
+
+TEST(TrafficTest, PopulationStaysAroundTheFocus) {
+    Vector3 focus = Terrain::get_start_position();
+    Traffic::spawn(64, focus);
+    float span = 0.0f;
+    for (int32_t i = 0; i < Traffic::get_count(); ++i) {
+        span = std::max(span, std::abs(Traffic::get_position(i).z - focus.z));
+    }
+    // drive the focus a long way; cars that fall behind re-enter ahead
+    for (int32_t step = 0; step < 600; ++step) {
+        focus.z += 2.0f;
+        Traffic::update(1.0f / 60.0f, focus);
+    }
+    for (int32_t i = 0; i < Traffic::get_count(); ++i) {
+        EXPECT_LE(std::abs(Traffic::get_position(i).z - focus.z), span + 2.0f) << i;
+    }
+    Traffic::cleanup();
+    Terrain::cleanup();
+}
+
+TEST(TrafficTest, EveryFocusKeepsTraffic) {
+    const Vector3 start = Terrain::get_start_position();
+    Traffic::spawn(64, start);
+    float span = 0.0f;
+    for (int32_t i = 0; i < Traffic::get_count(); ++i) {
+        span = std::max(span, std::abs(Traffic::get_position(i).z - start.z));
+    }
+    // the second player drives kilometres away from the first, who stays put
+    std::array<Vector3, 2> foci = {start, start};
+    for (int32_t step = 0; step < 600; ++step) {
+        foci[1].z += 5.0f;
+        Traffic::update(1.0f / 60.0f, foci);
+    }
+    std::array<int32_t, 2> around = {};
+    for (int32_t i = 0; i < Traffic::get_count(); ++i) {
+        const float z = Traffic::get_position(i).z;
+        const float to_first = std::abs(z - foci[0].z);
+        const float to_second = std::abs(z - foci[1].z);
+        EXPECT_LE(std::min(to_first, to_second), span + 5.0f) << i;
+        ++around[to_second < to_first ? 1 : 0];
+    }
+    EXPECT_GT(around[0], 0);
+    EXPECT_GT(around[1], 0);
+    Traffic::cleanup();
+    Terrain::cleanup();
+}
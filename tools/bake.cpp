@@ -0,0 +1,46 @@
+#include "atlas.hpp"
+#include "jobs.hpp"
+
+#include <charconv>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <optional>
+#include <string_view>
+
+namespace {
+
+std::optional<int32_t> parse_int(std::string_view text) {
+    int32_t value = 0;
+    const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (error != std::errc{} || end != text.data() + text.size()) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+} // namespace
+
+// offline baker for fixed-seed deployments: `bake <file> <min_cx> <min_cz> <width> <depth>`
+int32_t main(int32_t argc, char *argv[]) {
+    if (argc != 6) {
+        std::fprintf(stderr, "usage: %s <file> <min_cx> <min_cz> <width> <depth>\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    const std::optional<int32_t> min_cx = parse_int(argv[2]);
+    const std::optional<int32_t> min_cz = parse_int(argv[3]);
+    const std::optional<int32_t> width = parse_int(argv[4]);
+    const std::optional<int32_t> depth = parse_int(argv[5]);
+    if (!min_cx || !min_cz || !width || !depth) {
+        std::fprintf(stderr, "bake: region arguments must be integers\n");
+        return EXIT_FAILURE;
+    }
+
+    const bool ok = Atlas::bake(argv[1], *min_cx, *min_cz, *width, *depth);
+    Jobs::cleanup();
+    if (!ok) {
+        std::fprintf(stderr, "bake: failed to write %s\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}